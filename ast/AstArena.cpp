@@ -0,0 +1,98 @@
+/** @file
+ * @brief Definition of the AST arena.
+ *
+ * @author Jan Bobek
+ * @since 16th October 2026
+ */
+
+#include "ast/AstArena.hpp"
+
+/*************************************************************************/
+/* AstArena                                                              */
+/*************************************************************************/
+AstArena::AstArena()
+: mCur( NULL ),
+  mEnd( NULL ),
+  mUsed( 0 ),
+  mPeak( 0 )
+{
+}
+
+AstArena::~AstArena()
+{
+    std::vector< char* >::iterator cur, end;
+    cur = mBlocks.begin();
+    end = mBlocks.end();
+    for(; cur != end; ++cur )
+        delete[] *cur;
+}
+
+LexStr
+AstArena::copy(
+    const LexStr& str
+    )
+{
+    char* buf = static_cast< char* >(
+        alloc( str.len + 1 ) );
+
+    memcpy( buf, str.str, str.len );
+    buf[str.len] = '\0';
+
+    return LexStr( buf, str.len );
+}
+
+void
+AstArena::reset()
+{
+    mPeak = peakBytes();
+    mUsed = 0;
+
+    if( mBlocks.empty() )
+        return;
+
+    std::vector< char* >::iterator cur, end;
+    cur = mBlocks.begin() + 1;
+    end = mBlocks.end();
+    for(; cur != end; ++cur )
+        delete[] *cur;
+
+    mBlocks.resize( 1 );
+    mCur = mBlocks.front();
+    mEnd = mCur + AST_ARENA_BLOCK;
+}
+
+size_t
+AstArena::usedBytes() const
+{
+    return mUsed;
+}
+
+size_t
+AstArena::peakBytes() const
+{
+    return mPeak < mUsed ? mUsed : mPeak;
+}
+
+void*
+AstArena::allocBlock(
+    size_t size
+    )
+{
+    // Large allocations get a block of their own,
+    // so that the current one is not abandoned.
+    if( !mBlocks.empty() &&
+        AST_ARENA_BLOCK / 4 < size )
+    {
+        mBlocks.push_back( new char[size] );
+        return mBlocks.back();
+    }
+
+    size_t len = (size < AST_ARENA_BLOCK
+                  ? AST_ARENA_BLOCK : size);
+    char* block = new char[len];
+    mBlocks.push_back( block );
+
+    mCur = block + size;
+    mEnd = block + len;
+    return block;
+}
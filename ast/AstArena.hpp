@@ -0,0 +1,234 @@
+/** @file
+ * @brief Declaration of the AST arena.
+ *
+ * @author Jan Bobek
+ * @since 16th October 2026
+ */
+
+#ifndef SFE__AST__AST_ARENA_HPP__INCL__
+#define SFE__AST__AST_ARENA_HPP__INCL__
+
+#include <cstddef>
+#include <cstring>
+
+#include <new>
+#include <vector>
+
+#include "parser/LexAnalyzer.hpp"
+
+/// Size of a regular arena block.
+static const size_t AST_ARENA_BLOCK = 64 * 1024;
+/// Alignment of the arena allocations.
+static const size_t AST_ARENA_ALIGN = 8;
+
+/**
+ * @brief A bump-pointer arena for the AST.
+ *
+ * All nodes of a compilation unit live in one arena and
+ * are released together by reset(); no node is destroyed
+ * one by one. Hence, the nodes must not own anything
+ * outside the arena.
+ *
+ * @author Jan Bobek
+ */
+class AstArena
+{
+public:
+    /**
+     * @brief Initializes an empty arena.
+     */
+    AstArena();
+    /**
+     * @brief Releases all the blocks.
+     */
+    ~AstArena();
+
+    /**
+     * @brief Allocates memory from the arena.
+     *
+     * @param[in] size
+     *   Number of bytes to allocate.
+     *
+     * @return
+     *   The allocated memory.
+     */
+    void* alloc( size_t size );
+    /**
+     * @brief Copies a string into the arena.
+     *
+     * @param[in] str
+     *   The string to copy.
+     *
+     * @return
+     *   The copy, terminated by NUL.
+     */
+    LexStr copy( const LexStr& str );
+
+    /**
+     * @brief Releases everything allocated so far.
+     *
+     * The first block is kept for reuse.
+     */
+    void reset();
+
+    /**
+     * @brief Obtains the number of bytes allocated
+     *   since the last reset.
+     *
+     * @return
+     *   Number of bytes allocated.
+     */
+    size_t usedBytes() const;
+    /**
+     * @brief Obtains the largest number of bytes
+     *   ever allocated between two resets.
+     *
+     * @return
+     *   Peak number of bytes allocated.
+     */
+    size_t peakBytes() const;
+
+protected:
+    /**
+     * @brief Allocates memory from a new block.
+     *
+     * @param[in] size
+     *   Number of bytes to allocate, aligned.
+     *
+     * @return
+     *   The allocated memory.
+     */
+    void* allocBlock( size_t size );
+
+    /// All the blocks; the first one is regular.
+    std::vector< char* > mBlocks;
+    /// Free space in the current block.
+    char* mCur;
+    /// End of the current block.
+    char* mEnd;
+
+    /// Number of bytes allocated since the last reset.
+    size_t mUsed;
+    /// Peak of mUsed before the last reset.
+    size_t mPeak;
+};
+
+inline void*
+AstArena::alloc(
+    size_t size
+    )
+{
+    size = (size + AST_ARENA_ALIGN - 1) & ~(AST_ARENA_ALIGN - 1);
+    mUsed += size;
+
+    if( static_cast< size_t >( mEnd - mCur ) < size )
+        return allocBlock( size );
+
+    void* ptr = mCur;
+    mCur += size;
+    return ptr;
+}
+
+/**
+ * @brief A growable array allocated from an arena.
+ *
+ * Unlike std::vector, the list needs no destruction;
+ * storage outgrown by a push is left to the arena. The
+ * elements are never destroyed either, hence they must
+ * not own anything outside the arena.
+ *
+ * @author Jan Bobek
+ */
+template< typename T >
+class AstList
+{
+public:
+    /// Type of a mutable iterator.
+    typedef T* iterator;
+    /// Type of a constant iterator.
+    typedef const T* const_iterator;
+
+    /**
+     * @brief Initializes an empty list.
+     *
+     * @param[in] arena
+     *   The arena to allocate from.
+     */
+    AstList( AstArena& arena );
+
+    /**
+     * @brief Appends an element.
+     *
+     * @param[in] val
+     *   The element to append.
+     */
+    void push_back( const T& val );
+
+    /**
+     * @brief Obtains the number of elements.
+     *
+     * @return
+     *   Number of elements.
+     */
+    size_t size() const { return mSize; }
+    /// @brief Removes all elements.
+    void clear() { mSize = 0; }
+
+    /// @brief Obtains an element.
+    T& operator[]( size_t i ) { return mData[i]; }
+    /// @brief Obtains an element.
+    const T& operator[]( size_t i ) const { return mData[i]; }
+
+    /// @brief Obtains the start of the list.
+    iterator begin() { return mData; }
+    /// @brief Obtains the end of the list.
+    iterator end() { return mData + mSize; }
+    /// @brief Obtains the start of the list.
+    const_iterator begin() const { return mData; }
+    /// @brief Obtains the end of the list.
+    const_iterator end() const { return mData + mSize; }
+
+protected:
+    /// The arena to allocate from.
+    AstArena& mArena;
+    /// The elements.
+    T* mData;
+    /// Number of elements.
+    size_t mSize;
+    /// Number of allocated elements.
+    size_t mCapacity;
+};
+
+template< typename T >
+AstList< T >::AstList(
+    AstArena& arena
+    )
+: mArena( arena ),
+  mData( NULL ),
+  mSize( 0 ),
+  mCapacity( 0 )
+{
+}
+
+template< typename T >
+void
+AstList< T >::push_back(
+    const T& val
+    )
+{
+    if( mSize == mCapacity )
+    {
+        mCapacity = (0 < mCapacity ? 2 * mCapacity : 4);
+
+        T* data = static_cast< T* >(
+            mArena.alloc( mCapacity * sizeof(T) ) );
+        for( size_t i = 0; i < mSize; ++i )
+            new( &data[i] ) T( mData[i] );
+
+        mData = data;
+    }
+
+    new( &mData[mSize++] ) T( val );
+}
+
+#endif /* !SFE__AST__AST_ARENA_HPP__INCL__ */
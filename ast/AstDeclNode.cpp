@@ -7,6 +7,9 @@
 
 #include "sfe-lang.h"
 #include "ast/AstDeclNode.hpp"
+#include "ast/AstExprNode.hpp"
+#include "ast/AstFlat.hpp"
+#include "ast/AstFold.hpp"
 #include "ast/AstStmtNode.hpp"
 #include "ast/AstTypeNode.hpp"
 #include "parser/SymTable.hpp"
@@ -15,17 +18,20 @@
 /* AstDeclNode                                                           */
 /*************************************************************************/
 AstDeclNode::AstDeclNode(
-    const char* name
+    const Ident* name
     )
-: mName( name )
+: mName( name ),
+  mRef( NULL )
 {
+    mSym.decl = NULL_TREE;
+    mSym.off = 0;
 }
 
 /*************************************************************************/
 /* AstLocDeclNode                                                        */
 /*************************************************************************/
 AstLocDeclNode::AstLocDeclNode(
-    const char* name
+    const Ident* name
     )
 : AstDeclNode( name )
 {
@@ -35,8 +41,8 @@ AstLocDeclNode::AstLocDeclNode(
 /* AstConstDeclNode                                                      */
 /*************************************************************************/
 AstConstDeclNode::AstConstDeclNode(
-    const char* name,
-    int val
+    const Ident* name,
+    AstExprNode* val
     )
 : AstLocDeclNode( name ),
   mVal( val )
@@ -49,44 +55,91 @@ AstConstDeclNode::print(
     FILE* fp
     ) const
 {
-    fprintf( fp, "%*cconst %s = %d;\n",
-             off, ' ', mName.c_str(), mVal );
+    fprintf( fp, "%*cconst %s =\n",
+             off, ' ', mName->str );
+
+    mVal->print( off + 1, fp );
+
+    fprintf( fp, "%*c;\n", off, ' ' );
+}
+
+bool
+AstConstDeclNode::bind(
+    SymTable& symTable
+    )
+{
+    // The value is bound before the name is visible.
+    if( !mVal->bind( symTable ) )
+        return false;
+
+    return symTable.addVar(
+        mName, &mSym );
 }
 
 bool
 AstConstDeclNode::translate(
     tree& t,
-    tree ctx,
-    SymTable& symTable
+    tree ctx
     ) const
 {
-    t = symTable.getVar(
-        mName.c_str() );
+    if( !mVal->translate( t, ctx ) ||
+        !foldVal( mName->str, t ) )
+        return false;
 
-    if( NULL_TREE != t )
-        return true;
+    mSym.decl = t;
+    return true;
+}
 
-    t = build_decl(
-        UNKNOWN_LOCATION, VAR_DECL,
-        get_identifier( mName.c_str() ),
-        build_qualified_type(
-            integer_type_node, TYPE_QUAL_CONST ) );
-    TREE_ADDRESSABLE( t ) = true;
-    TREE_USED( t ) = true;
+uint32_t
+AstConstDeclNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    uint32_t val = mVal->flatten( flat );
 
-    DECL_INITIAL( t ) =
-        build_int_cst(
-            integer_type_node, mVal );
+    return flat.addNode(
+        ASTFLAT_CONST_DECL, mLoc, LEXTOK_EOI,
+        flat.addName( mName ), val );
+}
 
-    return symTable.addVar(
-        mName.c_str(), t );
+AstNode*
+AstConstDeclNode::foldConst(
+    AstFold& fold
+    )
+{
+    mVal = mVal->foldConst( fold );
+    return this;
+}
+
+bool
+AstConstDeclNode::foldVal(
+    const char* name,
+    tree& val
+    )
+{
+    val = fold( val );
+
+    if( INTEGER_CST != TREE_CODE( val ) )
+    {
+        fprintf( stderr, "Value of constant `%s' is not constant\n",
+                 name );
+        return false;
+    }
+    if( TREE_OVERFLOW( val ) )
+    {
+        fprintf( stderr, "Value of constant `%s' overflows\n",
+                 name );
+        return false;
+    }
+
+    return true;
 }
 
 /*************************************************************************/
 /* AstVarDeclNode                                                        */
 /*************************************************************************/
 AstVarDeclNode::AstVarDeclNode(
-    const char* name,
+    const Ident* name,
     AstTypeNode* type
     )
 : AstLocDeclNode( name ),
@@ -94,11 +147,6 @@ AstVarDeclNode::AstVarDeclNode(
 {
 }
 
-AstVarDeclNode::~AstVarDeclNode()
-{
-    delete mType;
-}
-
 void
 AstVarDeclNode::print(
     unsigned int off,
@@ -106,7 +154,7 @@ AstVarDeclNode::print(
     ) const
 {
     fprintf( fp, "%*cvar %s :\n",
-             off, ' ', mName.c_str() );
+             off, ' ', mName->str );
 
     mType->print( off + 1, fp );
 
@@ -114,57 +162,67 @@ AstVarDeclNode::print(
 }
 
 bool
-AstVarDeclNode::translate(
-    tree& t,
-    tree ctx,
+AstVarDeclNode::bind(
     SymTable& symTable
-    ) const
+    )
 {
-    t = mType->getSym(
-        mName.c_str(), symTable );
+    if( !mType->bind( symTable ) )
+        return false;
 
-    if( NULL_TREE != t )
-        return true;
+    return mType->addSym(
+        mName, &mSym, symTable );
+}
 
+bool
+AstVarDeclNode::translate(
+    tree& t,
+    tree ctx
+    ) const
+{
     tree type;
     if( !mType->translate(
-            type, NULL_TREE, symTable ) )
+            type, NULL_TREE ) )
         return false;
 
     t = build_decl(
-        UNKNOWN_LOCATION, VAR_DECL,
-        get_identifier( mName.c_str() ),
+        mLoc, VAR_DECL,
+        get_identifier( mName->str ),
         type );
     TREE_ADDRESSABLE( t ) = true;
     TREE_USED( t ) = true;
 
-    return mType->addSym(
-        mName.c_str(), t, symTable );
+    mSym.decl = t;
+    return true;
+}
+
+uint32_t
+AstVarDeclNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    uint32_t type = mType->flatten( flat );
+
+    return flat.addNode(
+        ASTFLAT_VAR_DECL, mLoc, LEXTOK_EOI,
+        flat.addName( mName ), type );
 }
 
 /*************************************************************************/
 /* AstFunDeclNode                                                        */
 /*************************************************************************/
 AstFunDeclNode::AstFunDeclNode(
-    const char* name
+    const Ident* name,
+    AstArena& arena
     )
 : AstDeclNode( name ),
+  mArgs( arena ),
+  mArgModes( arena ),
+  mArgSyms( arena ),
   mResType( NULL ),
   mBody( NULL )
 {
-}
-
-AstFunDeclNode::~AstFunDeclNode()
-{
-    ArgList::iterator cur, end;
-    cur = mArgs.begin();
-    end = mArgs.end();
-    for(; cur != end; ++cur )
-        delete cur->second;
-    mArgs.clear();
-
-    delete mResType;
-    delete mBody;
+    mRes.decl = NULL_TREE;
+    mRes.off = 0;
 }
 
 bool
@@ -181,12 +239,17 @@ AstFunDeclNode::isForward() const
 
 void
 AstFunDeclNode::addArg(
-    const char* name,
-    AstTypeNode* type
+    const Ident* name,
+    AstTypeNode* type,
+    LexToken mode
     )
 {
     mArgs.push_back(
         Arg( name, type ) );
+    mArgModes.push_back( mode );
+
+    AstSym sym = { NULL_TREE, 0 };
+    mArgSyms.push_back( sym );
 }
 
 void
@@ -194,7 +257,6 @@ AstFunDeclNode::setResType(
     AstTypeNode* type
     )
 {
-    delete mResType;
     mResType = type;
 }
 
@@ -203,7 +265,6 @@ AstFunDeclNode::setBody(
     AstBlkStmtNode* blk
     )
 {
-    delete mBody;
     mBody = blk;
 }
 
@@ -215,15 +276,18 @@ AstFunDeclNode::print(
 {
     fprintf( fp, "%*c%s %s(\n",
              off, ' ', (isProcedure() ? "procedure" : "function"),
-             mName.c_str() );
+             mName->str );
 
     ArgList::const_iterator cur, end;
     cur = mArgs.begin();
     end = mArgs.end();
-    for(; cur != end; ++cur )
+    for( unsigned int i = 0; cur != end; ++cur, ++i )
     {
-        fprintf( fp, "%*c%s :\n",
-                 off + 1, ' ', cur->first.c_str() );
+        fprintf( fp, "%*c%s%s :\n",
+                 off + 1, ' ',
+                 (LEXTOK_KW_VAR == mArgModes[i] ? "var " :
+                  LEXTOK_KW_CONST == mArgModes[i] ? "const " : ""),
+                 cur->first->str );
         cur->second->print( off + 2, fp );
     }
 
@@ -242,17 +306,60 @@ AstFunDeclNode::print(
         mBody->print( off + 1, fp );
 }
 
+bool
+AstFunDeclNode::bind(
+    SymTable& symTable
+    )
+{
+    ArgList::iterator cur, end;
+    cur = mArgs.begin();
+    end = mArgs.end();
+    for(; cur != end; ++cur )
+        if( !cur->second->bind( symTable ) )
+            return false;
+
+    if( !isProcedure() &&
+        !mResType->bind( symTable ) )
+        return false;
+
+    mRef = symTable.getFun(
+        mName );
+
+    if( NULL == mRef )
+    {
+        mRef = &mSym;
+        if( !symTable.addFun(
+                mName, &mSym ) )
+            return false;
+    }
+
+    if( isForward() )
+        return true;
+
+    SymScope scope( symTable );
+
+    if( !isProcedure() &&
+        (!symTable.setRes( &mRes ) ||
+         !mResType->addSym(
+             mName, &mRes, symTable )) )
+        return false;
+
+    for( unsigned int i = 0; i < mArgs.size(); ++i )
+        if( !mArgs[i].second->addSym(
+                mArgs[i].first,
+                &mArgSyms[i], symTable ) )
+            return false;
+
+    return mBody->bind( symTable );
+}
+
 bool
 AstFunDeclNode::translate(
     tree& t,
-    tree ctx,
-    SymTable& symTable
+    tree ctx
     ) const
 {
-    t = symTable.getFun(
-        mName.c_str() );
-
-    if( NULL_TREE == t )
+    if( &mSym == mRef )
     {
         tree params = NULL_TREE;
         tree params_decl = NULL_TREE;
@@ -260,26 +367,25 @@ AstFunDeclNode::translate(
         ArgList::const_iterator cur, end;
         cur = mArgs.begin();
         end = mArgs.end();
-        for(; cur != end; ++cur )
+        for( unsigned int i = 0; cur != end; ++cur, ++i )
         {
             tree param;
             if( !cur->second->translate(
-                    param, ctx, symTable ) )
+                    param, ctx ) )
                 return false;
 
             tree param_decl =
-                build_decl(
-                    UNKNOWN_LOCATION,
-                    PARM_DECL,
-                    get_identifier( cur->first.c_str() ),
+                buildParam(
+                    mLoc,
+                    cur->first->str,
+                    mArgModes[i],
                     param );
-            DECL_ARG_TYPE( param_decl ) = param;
 
             params = chainon(
                 params,
                 tree_cons(
                     NULL_TREE,
-                    param,
+                    DECL_ARG_TYPE( param_decl ),
                     NULL_TREE ) );
             params_decl = chainon(
                 params_decl,
@@ -290,7 +396,7 @@ AstFunDeclNode::translate(
         if( isProcedure() )
             restype = void_type_node;
         else if( !mResType->translate(
-                     restype, ctx, symTable ) )
+                     restype, ctx ) )
             return false;
 
         tree resdecl =
@@ -305,54 +411,40 @@ AstFunDeclNode::translate(
                 params );
 
         t = build_decl(
-            UNKNOWN_LOCATION,
+            mLoc,
             FUNCTION_DECL,
-            get_identifier( mName.c_str() ),
+            get_identifier( mName->str ),
             fntype );
         DECL_ARGUMENTS( t ) = params_decl;
         DECL_RESULT( t ) = resdecl;
         TREE_STATIC( t ) = true;
         TREE_PUBLIC( t ) = true;
 
-        if( !symTable.addFun(
-                mName.c_str(), t ) )
-            return false;
+        mSym.decl = t;
     }
 
+    t = mRef->decl;
+
     if( !isForward() )
     {
         if( NULL_TREE != DECL_SAVED_TREE( t ) )
         {
             fprintf( stderr, "Function `%s' defined more than once\n",
-                     mName.c_str() );
+                     mName->str );
             return false;
         }
 
-        SymTable subTable( symTable );
-
-        tree resdecl = DECL_RESULT( t );
-        if( !isProcedure() &&
-            (!subTable.setRes( resdecl ) ||
-             !mResType->addSym(
-                 mName.c_str(), resdecl, subTable )) )
-            return false;
+        mRes.decl = DECL_RESULT( t );
 
         tree params_decl = DECL_ARGUMENTS( t );
-        ArgList::const_iterator cur, end;
-        cur = mArgs.begin();
-        end = mArgs.end();
-        for(; cur != end; ++cur )
+        for( unsigned int i = 0; i < mArgSyms.size(); ++i )
         {
-            if( !cur->second->addSym(
-                    cur->first.c_str(),
-                    params_decl, subTable ) )
-                return false;
-
+            mArgSyms[i].decl = params_decl;
             params_decl = TREE_CHAIN( params_decl );
         }
 
         tree bind;
-        if( !mBody->translate( bind, t, subTable ) )
+        if( !mBody->translate( bind, t ) )
             return false;
 
         tree block =
@@ -365,24 +457,96 @@ AstFunDeclNode::translate(
     return true;
 }
 
+uint32_t
+AstFunDeclNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    std::vector< uint32_t > items;
+    items.push_back( isProcedure() ? ASTFLAT_NONE
+                     : mResType->flatten( flat ) );
+    items.push_back( isForward() ? ASTFLAT_NONE
+                     : mBody->flatten( flat ) );
+
+    ArgList::const_iterator cur, end;
+    cur = mArgs.begin();
+    end = mArgs.end();
+    for( unsigned int i = 0; cur != end; ++cur, ++i )
+    {
+        items.push_back( flat.addName( cur->first ) );
+        items.push_back( cur->second->flatten( flat ) );
+        items.push_back( mArgModes[i] );
+    }
+
+    return flat.addNode(
+        ASTFLAT_FUN_DECL, mLoc, LEXTOK_EOI,
+        flat.addName( mName ), flat.addList( items ),
+        mArgs.size() );
+}
+
+AstNode*
+AstFunDeclNode::foldConst(
+    AstFold& fold
+    )
+{
+    if( NULL != mBody )
+        mBody->foldConst( fold );
+
+    return this;
+}
+
+tree
+AstFunDeclNode::buildParam(
+    location_t loc,
+    const char* name,
+    LexToken mode,
+    tree type
+    )
+{
+#ifdef IN_GCC
+    if( LEXTOK_KW_VAR == mode )
+        type = build_pointer_type( type );
+    else if( LEXTOK_KW_CONST == mode &&
+             ARRAY_TYPE == TREE_CODE( type ) )
+        type = build_qualified_type(
+            build_pointer_type(
+                build_qualified_type(
+                    type, TYPE_QUAL_CONST ) ),
+            TYPE_QUAL_RESTRICT );
+#endif /* IN_GCC */
+
+    tree param_decl =
+        build_decl(
+            loc,
+            PARM_DECL,
+            get_identifier( name ),
+            type );
+    DECL_ARG_TYPE( param_decl ) = type;
+    TREE_READONLY( param_decl ) =
+        (LEXTOK_KW_CONST == mode);
+
+    return param_decl;
+}
+
 /*************************************************************************/
 /* AstProgDeclNode                                                       */
 /*************************************************************************/
 AstProgDeclNode::AstProgDeclNode(
-    const char* name
+    const Ident* name,
+    AstArena& arena
     )
-: AstDeclNode( name )
+: AstDeclNode( name ),
+  mGlobals( arena ),
+  mFunDecls( arena )
 {
 }
 
-AstProgDeclNode::~AstProgDeclNode()
+void
+AstProgDeclNode::addGlobal(
+    AstLocDeclNode* decl
+    )
 {
-    std::vector< AstFunDeclNode* >::iterator curf, endf;
-    curf = mFunDecls.begin();
-    endf = mFunDecls.end();
-    for(; curf != endf; ++curf )
-        delete *curf;
-    mFunDecls.clear();
+    mGlobals.push_back( decl );
 }
 
 void
@@ -399,29 +563,73 @@ AstProgDeclNode::print(
     FILE* fp
     ) const
 {
-    fprintf( fp, "%*cprogram %s\n", off, ' ', mName.c_str() );
+    fprintf( fp, "%*cprogram %s\n", off, ' ', mName->str );
+
+    AstList< AstLocDeclNode* >::const_iterator curg, endg;
+    curg = mGlobals.begin();
+    endg = mGlobals.end();
+    for(; curg != endg; ++curg )
+        (*curg)->print( off, fp );
 
-    std::vector< AstFunDeclNode* >::const_iterator curf, endf;
+    AstList< AstFunDeclNode* >::const_iterator curf, endf;
     curf = mFunDecls.begin();
     endf = mFunDecls.end();
     for(; curf != endf; ++curf )
         (*curf)->print( off, fp );
 }
 
+bool
+AstProgDeclNode::bind(
+    SymTable& symTable
+    )
+{
+    AstList< AstLocDeclNode* >::iterator curg, endg;
+    curg = mGlobals.begin();
+    endg = mGlobals.end();
+    for(; curg != endg; ++curg )
+        if( !(*curg)->bind( symTable ) )
+            return false;
+
+    AstList< AstFunDeclNode* >::iterator curf, endf;
+    curf = mFunDecls.begin();
+    endf = mFunDecls.end();
+    for(; curf != endf; ++curf )
+        if( !(*curf)->bind( symTable ) )
+            return false;
+
+    return true;
+}
+
 bool
 AstProgDeclNode::translate(
     tree& t,
-    tree ctx,
-    SymTable& symTable
+    tree ctx
     ) const
 {
-    std::vector< AstFunDeclNode* >::const_iterator curf, endf;
+    AstList< AstLocDeclNode* >::const_iterator curg, endg;
+    curg = mGlobals.begin();
+    endg = mGlobals.end();
+    for(; curg != endg; ++curg )
+    {
+        tree decl;
+        if( !(*curg)->translate( decl, ctx ) )
+            return false;
+
+        // Constants are substituted at their uses.
+        if( VAR_DECL == TREE_CODE( decl ) )
+        {
+            TREE_STATIC( decl ) = true;
+            register_global_variable_declaration( decl );
+        }
+    }
+
+    AstList< AstFunDeclNode* >::const_iterator curf, endf;
     curf = mFunDecls.begin();
     endf = mFunDecls.end();
     for(; curf != endf; ++curf )
     {
         tree fun;
-        if( !(*curf)->translate( fun, ctx, symTable ) )
+        if( !(*curf)->translate( fun, ctx ) )
             return false;
 
         if( !(*curf)->isForward() )
@@ -431,3 +639,48 @@ AstProgDeclNode::translate(
     t = NULL_TREE;
     return true;
 }
+
+uint32_t
+AstProgDeclNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    std::vector< uint32_t > decls;
+
+    AstList< AstLocDeclNode* >::const_iterator curg, endg;
+    curg = mGlobals.begin();
+    endg = mGlobals.end();
+    for(; curg != endg; ++curg )
+        decls.push_back( (*curg)->flatten( flat ) );
+
+    AstList< AstFunDeclNode* >::const_iterator curf, endf;
+    curf = mFunDecls.begin();
+    endf = mFunDecls.end();
+    for(; curf != endf; ++curf )
+        decls.push_back( (*curf)->flatten( flat ) );
+
+    return flat.addNode(
+        ASTFLAT_PROG_DECL, mLoc, LEXTOK_EOI,
+        flat.addName( mName ), flat.addList( decls ),
+        decls.size() );
+}
+
+AstNode*
+AstProgDeclNode::foldConst(
+    AstFold& fold
+    )
+{
+    AstList< AstLocDeclNode* >::iterator curg, endg;
+    curg = mGlobals.begin();
+    endg = mGlobals.end();
+    for(; curg != endg; ++curg )
+        (*curg)->foldConst( fold );
+
+    AstList< AstFunDeclNode* >::iterator curf, endf;
+    curf = mFunDecls.begin();
+    endf = mFunDecls.end();
+    for(; curf != endf; ++curf )
+        (*curf)->foldConst( fold );
+
+    return this;
+}
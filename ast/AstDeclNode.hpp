@@ -8,11 +8,13 @@
 #ifndef SFE__AST__AST_DECL_NODE_HPP__INCL__
 #define SFE__AST__AST_DECL_NODE_HPP__INCL__
 
-#include <string>
-#include <vector>
+#include <utility>
 
 #include "ast/AstNode.hpp"
+#include "parser/IdentTable.hpp"
+#include "parser/LexAnalyzer.hpp"
 
+class AstExprNode;
 class AstStmtNode;
 class AstBlkStmtNode;
 class AstTypeNode;
@@ -32,11 +34,16 @@ public:
      * @param[in] name
      *   Name of the element being declared/defined.
      */
-    AstDeclNode( const char* name );
+    AstDeclNode( const Ident* name );
 
 protected:
     /// Name of the element.
-    std::string mName;
+    const Ident* mName;
+    /// Slot of the element.
+    mutable AstSym mSym;
+    /// Slot the name is bound to, set by bind(); differs
+    /// from mSym if the function has been declared before.
+    const AstSym* mRef;
 };
 
 /**
@@ -54,7 +61,7 @@ public:
      * @param[in] name
      *   Name of the element being declared/defined.
      */
-    AstLocDeclNode( const char* name );
+    AstLocDeclNode( const Ident* name );
 };
 
 /**
@@ -75,8 +82,8 @@ public:
      *   Value of the constant.
      */
     AstConstDeclNode(
-        const char* name,
-        int val
+        const Ident* name,
+        AstExprNode* val
         );
 
     /**
@@ -91,6 +98,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -98,8 +117,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -108,13 +125,55 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node itself.
+     */
+    AstNode* foldConst( AstFold& fold );
+
+    /**
+     * @brief Folds the value of a constant.
+     *
+     * The value must fold to an integer constant
+     * which does not overflow; the constant is then
+     * substituted wherever it is used.
+     *
+     * @param[in] name
+     *   Name of the constant.
+     * @param[in,out] val
+     *   The translated value, replaced by the folded one.
+     *
+     * @retval true
+     *   Folding successful.
+     * @retval false
+     *   The value is not constant.
+     */
+    static bool foldVal(
+        const char* name,
+        tree& val
+        );
 
 protected:
     /// Value of the constant.
-    int mVal;
+    AstExprNode* mVal;
 };
 
 /**
@@ -135,13 +194,9 @@ public:
      *   Type of the variable.
      */
     AstVarDeclNode(
-        const char* name,
+        const Ident* name,
         AstTypeNode* type
         );
-    /**
-     * @brief Frees the type.
-     */
-    ~AstVarDeclNode();
 
     /**
      * @brief Prints the node to a file.
@@ -155,6 +210,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -162,8 +229,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -172,9 +237,18 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
 
 protected:
     /// Type of the variable.
@@ -191,21 +265,22 @@ class AstFunDeclNode
 {
 public:
     /// Declarative description of an argument.
-    typedef std::pair< std::string, AstTypeNode* > Arg;
+    typedef std::pair< const Ident*, AstTypeNode* > Arg;
     /// List of arguments.
-    typedef std::vector< Arg > ArgList;
+    typedef AstList< Arg > ArgList;
 
     /**
      * @brief Initializes the node.
      *
      * @param[in] name
      *   Name of the function.
+     * @param[in] arena
+     *   The arena to allocate arguments from.
      */
-    AstFunDeclNode( const char* name );
-    /**
-     * @brief Frees the types and body.
-     */
-    ~AstFunDeclNode();
+    AstFunDeclNode(
+        const Ident* name,
+        AstArena& arena
+        );
 
     /**
      * @brief Checks if this is a procedure.
@@ -233,10 +308,15 @@ public:
      *   Name of the argument.
      * @param[in] type
      *   Type of the argument.
+     * @param[in] mode
+     *   LEXTOK_KW_VAR or LEXTOK_KW_CONST to pass
+     *   the argument by reference, LEXTOK_EOI to
+     *   pass it by value.
      */
     void addArg(
-        const char* name,
-        AstTypeNode* type
+        const Ident* name,
+        AstTypeNode* type,
+        LexToken mode
         );
     /**
      * @brief Sets the result type.
@@ -265,6 +345,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -272,8 +364,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -282,15 +372,68 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node itself.
+     */
+    AstNode* foldConst( AstFold& fold );
+
+    /**
+     * @brief Builds the declaration of an argument.
+     *
+     * Var arguments are passed as pointers. Const
+     * arrays are passed as restrict pointers to
+     * constant arrays, other const arguments by
+     * value; neither may be modified.
+     *
+     * @param[in] loc
+     *   Location of the function.
+     * @param[in] name
+     *   Name of the argument.
+     * @param[in] mode
+     *   LEXTOK_KW_VAR, LEXTOK_KW_CONST or LEXTOK_EOI.
+     * @param[in] type
+     *   The translated type of the argument.
+     *
+     * @return
+     *   The PARM_DECL.
+     */
+    static tree buildParam(
+        location_t loc,
+        const char* name,
+        LexToken mode,
+        tree type
+        );
 
 protected:
     /// Names and types of the arguments.
     ArgList mArgs;
+    /// Passing modes of the arguments.
+    AstList< LexToken > mArgModes;
+    /// Slots of the arguments.
+    mutable AstList< AstSym > mArgSyms;
     /// Type of the result.
     AstTypeNode* mResType;
+    /// Slot of the result.
+    mutable AstSym mRes;
     /// Body of the function.
     AstBlkStmtNode* mBody;
 };
@@ -309,19 +452,24 @@ public:
      *
      * @param[in] name
      *   Name of the program.
-     * @param[in] funs
-     *   Global function declarations.
-     * @param[in] vars
-     *   Global variable declarations.
-     * @param[in] mainBlk
-     *   Main block.
+     * @param[in] arena
+     *   The arena to allocate declarations from.
      */
-    AstProgDeclNode( const char* name );
+    AstProgDeclNode(
+        const Ident* name,
+        AstArena& arena
+        );
+
     /**
-     * @brief Frees the contained functions.
+     * @brief Adds a global declaration.
+     *
+     * Globals have static storage and are visible
+     * in all the functions.
+     *
+     * @param[in] decl
+     *   The declaration to add.
      */
-    ~AstProgDeclNode();
-
+    void addGlobal( AstLocDeclNode* decl );
     /**
      * @brief Adds a function declaration.
      *
@@ -342,6 +490,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates the program.
      *
@@ -349,8 +509,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -359,13 +517,35 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node itself.
+     */
+    AstNode* foldConst( AstFold& fold );
 
 protected:
+    /// Global declarations.
+    AstList< AstLocDeclNode* > mGlobals;
     /// Function declarations.
-    std::vector< AstFunDeclNode* > mFunDecls;
+    AstList< AstFunDeclNode* > mFunDecls;
 };
 
 #endif /* !SFE__AST__AST_DECL_NODE_HPP__INCL__ */
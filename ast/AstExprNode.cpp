@@ -6,8 +6,46 @@
  */
 
 #include "ast/AstExprNode.hpp"
+#include "ast/AstFlat.hpp"
+#include "ast/AstFold.hpp"
+#include "ast/AstLib.hpp"
 #include "parser/SymTable.hpp"
 
+/*************************************************************************/
+/* AstExprNode                                                           */
+/*************************************************************************/
+bool
+AstExprNode::bindArg(
+    SymTable& symTable
+    )
+{
+    return bind( symTable );
+}
+
+AstExprNode*
+AstExprNode::foldConst(
+    AstFold&
+    )
+{
+    return this;
+}
+
+AstExprNode*
+AstExprNode::foldConstArg(
+    AstFold& fold
+    )
+{
+    return foldConst( fold );
+}
+
+bool
+AstExprNode::getInt(
+    int&
+    ) const
+{
+    return false;
+}
+
 /*************************************************************************/
 /* AstIntExprNode                                                        */
 /*************************************************************************/
@@ -31,11 +69,18 @@ AstIntExprNode::print(
         mVal );
 }
 
+bool
+AstIntExprNode::bind(
+    SymTable&
+    )
+{
+    return true;
+}
+
 bool
 AstIntExprNode::translate(
     tree& t,
-    tree,
-    SymTable&
+    tree
     ) const
 {
     t = build_int_cst(
@@ -44,11 +89,30 @@ AstIntExprNode::translate(
     return true;
 }
 
+uint32_t
+AstIntExprNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    return flat.addNode(
+        ASTFLAT_INT_EXPR, mLoc, LEXTOK_EOI,
+        static_cast< uint32_t >( mVal ) );
+}
+
+bool
+AstIntExprNode::getInt(
+    int& val
+    ) const
+{
+    val = mVal;
+    return true;
+}
+
 /*************************************************************************/
 /* AstStrExprNode                                                        */
 /*************************************************************************/
 AstStrExprNode::AstStrExprNode(
-    const char* str
+    const LexStr& str
     )
 : mStr( str )
 {
@@ -64,46 +128,47 @@ AstStrExprNode::print(
         fp,
         "%*c'%s'\n",
         off, ' ',
-        mStr.c_str() );
+        mStr.str );
+}
+
+bool
+AstStrExprNode::bind(
+    SymTable&
+    )
+{
+    return true;
 }
 
 bool
 AstStrExprNode::translate(
     tree& t,
-    tree,
-    SymTable&
+    tree
     ) const
 {
-    tree idx_type = build_index_type(
-        size_int( mStr.length() ) );
-    tree elem_type =
-        build_qualified_type(
-            unsigned_char_type_node,
-            TYPE_QUAL_CONST );
-    tree string_type =
-        build_array_type( elem_type, idx_type );
-    TYPE_STRING_FLAG( string_type ) = 1;
-
-    tree str = build_string(
-        mStr.length() + 1,
-        mStr.c_str() );
-    TREE_TYPE( str ) = string_type;
-
-    t = build1(
-        ADDR_EXPR, build_pointer_type(
-            TREE_TYPE( str ) ),
-        str );
+    t = AstLib::global().getStr(
+        mStr.str, mStr.len );
 
     return true;
 }
 
+uint32_t
+AstStrExprNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    return flat.addNode(
+        ASTFLAT_STR_EXPR, mLoc, LEXTOK_EOI,
+        flat.addStr( mStr ), mStr.len );
+}
+
 /*************************************************************************/
 /* AstVarExprNode                                                        */
 /*************************************************************************/
 AstVarExprNode::AstVarExprNode(
-    const char* name
+    const Ident* name
     )
-: mName( name )
+: mName( name ),
+  mSym( NULL )
 {
 }
 
@@ -117,45 +182,79 @@ AstVarExprNode::print(
         fp,
         "%*c%s\n",
         off, ' ',
-        mName.c_str() );
+        mName->str );
 }
 
 bool
-AstVarExprNode::translate(
-    tree& t,
-    tree,
+AstVarExprNode::bind(
     SymTable& symTable
-    ) const
+    )
+{
+    mSym = symTable.getVar( mName );
+
+    if( NULL == mSym )
+    {
+        fprintf( stderr, "Unknown variable `%s'\n",
+                 mName->str );
+        return false;
+    }
+
+    return true;
+}
+
+bool
+AstVarExprNode::bindArg(
+    SymTable& symTable
+    )
 {
-    t = symTable.getVar( mName.c_str() );
+    mSym = symTable.getVar( mName );
+
+    if( NULL == mSym )
+        mSym = symTable.getArr( mName );
 
-    if( NULL_TREE == t )
+    if( NULL == mSym )
     {
         fprintf( stderr, "Unknown variable `%s'\n",
-                 mName.c_str() );
+                 mName->str );
         return false;
     }
 
     return true;
 }
 
+bool
+AstVarExprNode::translate(
+    tree& t,
+    tree
+    ) const
+{
+    t = astDeref( mSym->decl );
+    return true;
+}
+
+uint32_t
+AstVarExprNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    return flat.addNode(
+        ASTFLAT_VAR_EXPR, mLoc, LEXTOK_EOI,
+        flat.addName( mName ) );
+}
+
 /*************************************************************************/
 /* AstArrExprNode                                                        */
 /*************************************************************************/
 AstArrExprNode::AstArrExprNode(
-    const char* name,
+    const Ident* name,
     AstExprNode* index
     )
 : mName( name ),
+  mSym( NULL ),
   mIndex( index )
 {
 }
 
-AstArrExprNode::~AstArrExprNode()
-{
-    delete mIndex;
-}
-
 void
 AstArrExprNode::print(
     unsigned int off,
@@ -166,7 +265,7 @@ AstArrExprNode::print(
         fp,
         "%*c%s[\n",
         off, ' ',
-        mName.c_str() );
+        mName->str );
 
     mIndex->print( off + 1, fp );
 
@@ -177,61 +276,84 @@ AstArrExprNode::print(
 }
 
 bool
-AstArrExprNode::translate(
-    tree& t,
-    tree ctx,
+AstArrExprNode::bind(
     SymTable& symTable
-    ) const
+    )
 {
-    int off;
-    tree array = symTable.getArr(
-        mName.c_str(), off );
+    mSym = symTable.getArr( mName );
 
-    if( NULL_TREE == array )
+    if( NULL == mSym )
     {
         fprintf( stderr, "Unknown array `%s'\n",
-                 mName.c_str() );
+                 mName->str );
         return false;
     }
 
+    return mIndex->bind( symTable );
+}
+
+bool
+AstArrExprNode::translate(
+    tree& t,
+    tree ctx
+    ) const
+{
+    tree array = astDeref( mSym->decl );
+    int off = mSym->off;
+
     tree index;
     if( !mIndex->translate(
-            index, ctx, symTable ) )
+            index, ctx ) )
         return false;
 
     if( 0 < off )
-        index = build2(
-            PLUS_EXPR, TREE_TYPE( index ), index,
+        index = build2_loc(
+            mLoc, PLUS_EXPR, TREE_TYPE( index ), index,
             build_int_cst( integer_type_node, off ) );
     else if( 0 > off )
-        index = build2(
-            MINUS_EXPR, TREE_TYPE( index ), index,
+        index = build2_loc(
+            mLoc, MINUS_EXPR, TREE_TYPE( index ), index,
             build_int_cst( integer_type_node, -off ) );
 
-    t = build4(
-        ARRAY_REF, TREE_TYPE( TREE_TYPE( array ) ),
+    t = build4_loc(
+        mLoc, ARRAY_REF, TREE_TYPE( TREE_TYPE( array ) ),
         array, index, NULL_TREE, NULL_TREE );
 
     return true;
 }
 
+uint32_t
+AstArrExprNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    uint32_t index = mIndex->flatten( flat );
+
+    return flat.addNode(
+        ASTFLAT_ARR_EXPR, mLoc, LEXTOK_EOI,
+        flat.addName( mName ), index );
+}
+
+AstExprNode*
+AstArrExprNode::foldConst(
+    AstFold& fold
+    )
+{
+    mIndex = mIndex->foldConst( fold );
+    return this;
+}
+
 /*************************************************************************/
 /* AstFunExprNode                                                        */
 /*************************************************************************/
 AstFunExprNode::AstFunExprNode(
-    const char* name
+    const Ident* name,
+    AstArena& arena
     )
-: mName( name )
-{
-}
-
-AstFunExprNode::~AstFunExprNode()
+: mName( name ),
+  mSym( NULL ),
+  mArgs( arena )
 {
-    std::vector< AstExprNode* >::iterator cur, end;
-    cur = mArgs.begin();
-    end = mArgs.end();
-    for(; cur != end; ++cur )
-        delete *cur;
 }
 
 void
@@ -248,9 +370,9 @@ AstFunExprNode::print(
     FILE* fp
     ) const
 {
-    fprintf( fp, "%*c%s(\n", off, ' ', mName.c_str() );
+    fprintf( fp, "%*c%s(\n", off, ' ', mName->str );
 
-    std::vector< AstExprNode* >::const_iterator cur, end;
+    AstList< AstExprNode* >::const_iterator cur, end;
     cur = mArgs.begin();
     end = mArgs.end();
     for(; cur != end; ++cur )
@@ -265,36 +387,176 @@ AstFunExprNode::print(
 }
 
 bool
-AstFunExprNode::translate(
-    tree& t,
-    tree ctx,
+AstFunExprNode::bind(
     SymTable& symTable
-    ) const
+    )
 {
-    tree fndecl =
-        symTable.getFun( mName.c_str() );
+    mSym = symTable.getFun( mName );
 
-    if( NULL_TREE == fndecl )
+    if( NULL == mSym )
     {
         fprintf( stderr, "Unknown function `%s'\n",
-                 mName.c_str() );
+                 mName->str );
         return false;
     }
 
-    tree* argv = XNEWVEC( tree, mArgs.size() );
+    AstList< AstExprNode* >::iterator cur, end;
+    cur = mArgs.begin();
+    end = mArgs.end();
+    for(; cur != end; ++cur )
+        if( !(*cur)->bindArg( symTable ) )
+            return false;
+
+    return true;
+}
+
+bool
+AstFunExprNode::translate(
+    tree& t,
+    tree ctx
+    ) const
+{
+    tree fndecl = mSym->decl;
+
+    std::vector< tree > args( mArgs.size() );
     for( unsigned int i = 0; i < mArgs.size(); ++i )
-        if( !mArgs[i]->translate( argv[i], ctx, symTable ) )
+        if( !mArgs[i]->translate( args[i], ctx ) )
             return false;
 
+    tree* argv = (args.empty() ? NULL : &args[0]);
+    if( !buildArgs( mLoc, fndecl, mArgs.size(), argv ) )
+        return false;
+
     t = build_call_expr_loc_array(
-        UNKNOWN_LOCATION, fndecl,
+        mLoc, fndecl,
         mArgs.size(), argv );
-    SET_EXPR_LOCATION( t, UNKNOWN_LOCATION );
+    SET_EXPR_LOCATION( t, mLoc );
     TREE_USED( t ) = true;
 
     return true;
 }
 
+uint32_t
+AstFunExprNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    std::vector< uint32_t > args;
+
+    AstList< AstExprNode* >::const_iterator cur, end;
+    cur = mArgs.begin();
+    end = mArgs.end();
+    for(; cur != end; ++cur )
+        args.push_back( (*cur)->flatten( flat ) );
+
+    return flat.addNode(
+        ASTFLAT_FUN_EXPR, mLoc, LEXTOK_EOI,
+        flat.addName( mName ), flat.addList( args ),
+        args.size() );
+}
+
+AstExprNode*
+AstFunExprNode::foldConst(
+    AstFold& fold
+    )
+{
+    AstList< AstExprNode* >::iterator cur, end;
+    cur = mArgs.begin();
+    end = mArgs.end();
+    for(; cur != end; ++cur )
+        *cur = (*cur)->foldConstArg( fold );
+
+    return this;
+}
+
+bool
+AstFunExprNode::buildArgs(
+    location_t loc,
+    tree fndecl,
+    unsigned int argc,
+    tree* argv
+    )
+{
+#ifdef IN_GCC
+    const char* name =
+        IDENTIFIER_POINTER( DECL_NAME( fndecl ) );
+    tree parms =
+        TYPE_ARG_TYPES( TREE_TYPE( fndecl ) );
+
+    for( unsigned int i = 0; i < argc; ++i )
+    {
+        if( NULL_TREE == parms )
+        {
+            fprintf( stderr, "Too many arguments to `%s'\n",
+                     name );
+            return false;
+        }
+
+        tree type = TREE_VALUE( parms );
+        tree argType = TREE_TYPE( argv[i] );
+        parms = TREE_CHAIN( parms );
+
+        // Arguments passed by reference have pointer types.
+        if( POINTER_TYPE != TREE_CODE( type ) )
+        {
+            if( TYPE_MAIN_VARIANT( type ) !=
+                TYPE_MAIN_VARIANT( argType ) )
+            {
+                fprintf( stderr, "Argument %u to `%s' has incompatible type\n",
+                         i + 1, name );
+                return false;
+            }
+
+            continue;
+        }
+
+        if( TYPE_MAIN_VARIANT( TREE_TYPE( type ) ) !=
+            TYPE_MAIN_VARIANT( argType ) )
+        {
+            fprintf( stderr, "Argument %u to `%s' has incompatible type\n",
+                     i + 1, name );
+            return false;
+        }
+
+        if( VAR_DECL != TREE_CODE( argv[i] ) &&
+            PARM_DECL != TREE_CODE( argv[i] ) &&
+            RESULT_DECL != TREE_CODE( argv[i] ) &&
+            ARRAY_REF != TREE_CODE( argv[i] ) &&
+            INDIRECT_REF != TREE_CODE( argv[i] ) )
+        {
+            fprintf( stderr, "Argument %u to `%s' must be a variable\n",
+                     i + 1, name );
+            return false;
+        }
+
+        if( !TYPE_READONLY( TREE_TYPE( type ) ) )
+        {
+            if( !astWritable( argv[i] ) )
+                return false;
+
+            if( TYPE_READONLY( argType ) )
+            {
+                fprintf( stderr, "Argument %u to `%s' must be a variable\n",
+                         i + 1, name );
+                return false;
+            }
+        }
+
+        argv[i] = fold_convert(
+            type, build_fold_addr_expr_loc( loc, argv[i] ) );
+    }
+
+    if( NULL_TREE != parms )
+    {
+        fprintf( stderr, "Too few arguments to `%s'\n",
+                 name );
+        return false;
+    }
+#endif /* IN_GCC */
+
+    return true;
+}
+
 /*************************************************************************/
 /* AstUnopExprNode                                                       */
 /*************************************************************************/
@@ -307,11 +569,6 @@ AstUnopExprNode::AstUnopExprNode(
 {
 }
 
-AstUnopExprNode::~AstUnopExprNode()
-{
-    delete mOp;
-}
-
 void
 AstUnopExprNode::print(
     unsigned int off,
@@ -327,21 +584,69 @@ AstUnopExprNode::print(
     mOp->print( off + 1, fp );
 }
 
+bool
+AstUnopExprNode::bind(
+    SymTable& symTable
+    )
+{
+    return mOp->bind( symTable );
+}
+
 bool
 AstUnopExprNode::translate(
     tree& t,
-    tree ctx,
-    SymTable& symTable
+    tree ctx
     ) const
 {
     tree op;
-    if( !mOp->translate( op, ctx, symTable ) )
+    if( !mOp->translate( op, ctx ) )
         return false;
 
-    switch( mToken )
+    return buildOp( mLoc, mToken, op, t );
+}
+
+uint32_t
+AstUnopExprNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    uint32_t op = mOp->flatten( flat );
+
+    return flat.addNode(
+        ASTFLAT_UNOP_EXPR, mLoc, mToken, op );
+}
+
+AstExprNode*
+AstUnopExprNode::foldConst(
+    AstFold& fold
+    )
+{
+    mOp = mOp->foldConst( fold );
+
+    int op, val;
+    if( mOp->getInt( op ) &&
+        AstFold::evalUnop( mToken, op, val ) )
+        return fold.foldInt( mLoc, val );
+
+    return this;
+}
+
+bool
+AstUnopExprNode::buildOp(
+    location_t loc,
+    LexToken token,
+    tree op,
+    tree& t
+    )
+{
+    switch( token )
     {
-    case LEXTOK_MINUS: t = build1( NEGATE_EXPR,    TREE_TYPE( op ), op ); return true;
-    case LEXTOK_NOT:   t = build1( TRUTH_NOT_EXPR, TREE_TYPE( op ), op ); return true;
+    case LEXTOK_MINUS: t = build1_loc( loc, NEGATE_EXPR,    TREE_TYPE( op ), op ); return true;
+    case LEXTOK_NOT:
+        t = astIntValue( build1_loc(
+            loc, TRUTH_NOT_EXPR, boolean_type_node,
+            astTruthValue( loc, op ) ) );
+        return true;
 
     default: t = NULL_TREE; return false;
     }
@@ -361,12 +666,6 @@ AstBinopExprNode::AstBinopExprNode(
 {
 }
 
-AstBinopExprNode::~AstBinopExprNode()
-{
-    delete mLeft;
-    delete mRight;
-}
-
 void
 AstBinopExprNode::print(
     unsigned int off,
@@ -397,36 +696,149 @@ AstBinopExprNode::print(
     mRight->print( off + 1, fp );
 }
 
+bool
+AstBinopExprNode::bind(
+    SymTable& symTable
+    )
+{
+    return mLeft->bind( symTable ) &&
+        mRight->bind( symTable );
+}
+
 bool
 AstBinopExprNode::translate(
     tree& t,
-    tree ctx,
-    SymTable& symTable
+    tree ctx
     ) const
 {
     tree left, right;
-    if( !mLeft->translate( left, ctx, symTable ) ||
-        !mRight->translate( right, ctx, symTable ) )
+    if( !mLeft->translate( left, ctx ) ||
+        !mRight->translate( right, ctx ) )
         return false;
 
-    switch( mToken )
+    return buildOp( mLoc, mToken, left, right, t );
+}
+
+uint32_t
+AstBinopExprNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    uint32_t left = mLeft->flatten( flat );
+    uint32_t right = mRight->flatten( flat );
+
+    return flat.addNode(
+        ASTFLAT_BINOP_EXPR, mLoc, mToken, left, right );
+}
+
+AstExprNode*
+AstBinopExprNode::foldConst(
+    AstFold& fold
+    )
+{
+    return foldOps( fold, true );
+}
+
+AstExprNode*
+AstBinopExprNode::foldConstArg(
+    AstFold& fold
+    )
+{
+    return foldOps( fold, false );
+}
+
+bool
+AstBinopExprNode::buildOp(
+    location_t loc,
+    LexToken token,
+    tree left,
+    tree right,
+    tree& t
+    )
+{
+    switch( token )
     {
-    case LEXTOK_PLUS:  t = build2( PLUS_EXPR,      TREE_TYPE( left ), left, right ); return true;
-    case LEXTOK_MINUS: t = build2( MINUS_EXPR,     TREE_TYPE( left ), left, right ); return true;
-    case LEXTOK_MULT:  t = build2( MULT_EXPR,      TREE_TYPE( left ), left, right ); return true;
-    case LEXTOK_DIV:   t = build2( TRUNC_DIV_EXPR, TREE_TYPE( left ), left, right ); return true;
-    case LEXTOK_MOD:   t = build2( TRUNC_MOD_EXPR, TREE_TYPE( left ), left, right ); return true;
-
-    case LEXTOK_EQ:  t = build2( EQ_EXPR, TREE_TYPE( left ), left, right ); return true;
-    case LEXTOK_NEQ: t = build2( NE_EXPR, TREE_TYPE( left ), left, right ); return true;
-    case LEXTOK_LT:  t = build2( LT_EXPR, TREE_TYPE( left ), left, right ); return true;
-    case LEXTOK_LEQ: t = build2( LE_EXPR, TREE_TYPE( left ), left, right ); return true;
-    case LEXTOK_GT:  t = build2( GT_EXPR, TREE_TYPE( left ), left, right ); return true;
-    case LEXTOK_GEQ: t = build2( GE_EXPR, TREE_TYPE( left ), left, right ); return true;
-
-    case LEXTOK_OR:  t = build2( TRUTH_OR_EXPR,  TREE_TYPE( left ), left, right ); return true;
-    case LEXTOK_AND: t = build2( TRUTH_AND_EXPR, TREE_TYPE( left ), left, right ); return true;
+    case LEXTOK_PLUS:  t = build2_loc( loc, PLUS_EXPR,      TREE_TYPE( left ), left, right ); return true;
+    case LEXTOK_MINUS: t = build2_loc( loc, MINUS_EXPR,     TREE_TYPE( left ), left, right ); return true;
+    case LEXTOK_MULT:  t = build2_loc( loc, MULT_EXPR,      TREE_TYPE( left ), left, right ); return true;
+    case LEXTOK_DIV:   t = build2_loc( loc, TRUNC_DIV_EXPR, TREE_TYPE( left ), left, right ); return true;
+    case LEXTOK_MOD:   t = build2_loc( loc, TRUNC_MOD_EXPR, TREE_TYPE( left ), left, right ); return true;
+
+    case LEXTOK_EQ:  t = astIntValue( build2_loc( loc, EQ_EXPR, boolean_type_node, left, right ) ); return true;
+    case LEXTOK_NEQ: t = astIntValue( build2_loc( loc, NE_EXPR, boolean_type_node, left, right ) ); return true;
+    case LEXTOK_LT:  t = astIntValue( build2_loc( loc, LT_EXPR, boolean_type_node, left, right ) ); return true;
+    case LEXTOK_LEQ: t = astIntValue( build2_loc( loc, LE_EXPR, boolean_type_node, left, right ) ); return true;
+    case LEXTOK_GT:  t = astIntValue( build2_loc( loc, GT_EXPR, boolean_type_node, left, right ) ); return true;
+    case LEXTOK_GEQ: t = astIntValue( build2_loc( loc, GE_EXPR, boolean_type_node, left, right ) ); return true;
+
+    // Unless asked for full evaluation, the right operand
+    // is skipped when the left one decides the result.
+    case LEXTOK_OR:
+        t = astIntValue( build2_loc(
+            loc, flag_full_boolean_eval ? TRUTH_OR_EXPR : TRUTH_ORIF_EXPR,
+            boolean_type_node, astTruthValue( loc, left ),
+            astTruthValue( loc, right ) ) );
+        return true;
+    case LEXTOK_AND:
+        t = astIntValue( build2_loc(
+            loc, flag_full_boolean_eval ? TRUTH_AND_EXPR : TRUTH_ANDIF_EXPR,
+            boolean_type_node, astTruthValue( loc, left ),
+            astTruthValue( loc, right ) ) );
+        return true;
 
     default: t = NULL_TREE; return false;
     }
 }
+
+AstExprNode*
+AstBinopExprNode::foldOps(
+    AstFold& fold,
+    bool neutral
+    )
+{
+    mLeft = mLeft->foldConst( fold );
+    mRight = mRight->foldConst( fold );
+
+    int left, right, val;
+    bool isLeft = mLeft->getInt( left );
+    bool isRight = mRight->getInt( right );
+
+    if( isLeft && isRight )
+    {
+        if( AstFold::evalBinop( mToken, left, right, val ) )
+            return fold.foldInt( mLoc, val );
+
+        return this;
+    }
+
+    if( !neutral )
+        return this;
+
+    // Only a constant operand is ever dropped, so
+    // no side effect nor unresolved name gets lost.
+    switch( mToken )
+    {
+    case LEXTOK_PLUS:
+        if( isLeft && 0 == left )
+            return fold.foldTo( mRight );
+        // Fall through.
+    case LEXTOK_MINUS:
+        if( isRight && 0 == right )
+            return fold.foldTo( mLeft );
+        break;
+
+    case LEXTOK_MULT:
+        if( isLeft && 1 == left )
+            return fold.foldTo( mRight );
+        // Fall through.
+    case LEXTOK_DIV:
+        if( isRight && 1 == right )
+            return fold.foldTo( mLeft );
+        break;
+
+    default:
+        break;
+    }
+
+    return this;
+}
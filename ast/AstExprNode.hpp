@@ -8,8 +8,6 @@
 #ifndef SFE__AST__AST_EXPR_NODE_HPP__INCL__
 #define SFE__AST__AST_EXPR_NODE_HPP__INCL__
 
-#include <vector>
-
 #include "ast/AstNode.hpp"
 #include "parser/LexAnalyzer.hpp"
 
@@ -21,6 +19,58 @@
 class AstExprNode
 : public AstNode
 {
+public:
+    /**
+     * @brief Resolves names in a function argument.
+     *
+     * Unlike elsewhere, a whole array may be
+     * passed as an argument.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    virtual bool bindArg( SymTable& symTable );
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node to use instead.
+     */
+    AstExprNode* foldConst( AstFold& fold );
+    /**
+     * @brief Folds constant operations in a function argument.
+     *
+     * Unlike elsewhere, the argument must not turn into
+     * a variable, which could be passed by reference.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node to use instead.
+     */
+    virtual AstExprNode* foldConstArg( AstFold& fold );
+    /**
+     * @brief Tells whether the node is a constant.
+     *
+     * @param[out] val
+     *   Value of the constant.
+     *
+     * @retval true
+     *   The node is a constant.
+     * @retval false
+     *   The node is not a constant.
+     */
+    virtual bool getInt( int& val ) const;
 };
 
 /**
@@ -52,6 +102,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree node.
      *
@@ -59,8 +121,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -69,9 +129,29 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Tells whether the node is a constant.
+     *
+     * @param[out] val
+     *   Value of the constant.
+     *
+     * @retval true
+     *   Always.
+     */
+    bool getInt( int& val ) const;
 
 protected:
     /// Value of the number.
@@ -90,10 +170,13 @@ public:
     /**
      * @brief Initializes the node.
      *
+     * The string is not copied; it must be terminated
+     * by NUL and outlive the node.
+     *
      * @param[in] str
      *   Literal value of the string.
      */
-    AstStrExprNode( const char* str );
+    AstStrExprNode( const LexStr& str );
 
     /**
      * @brief Prints the node to a file.
@@ -107,6 +190,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -114,8 +209,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -124,13 +217,22 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
 
 protected:
     /// Literal value of the string.
-    std::string mStr;
+    LexStr mStr;
 };
 
 /**
@@ -148,7 +250,7 @@ public:
      * @param[in] name
      *   The identifier being referenced.
      */
-    AstVarExprNode( const char* name );
+    AstVarExprNode( const Ident* name );
 
     /**
      * @brief Prints the node to a file.
@@ -162,6 +264,30 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
+    /**
+     * @brief Resolves names in a function argument.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bindArg( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -169,8 +295,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -179,13 +303,24 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
 
 protected:
     /// Identifier being referenced.
-    std::string mName;
+    const Ident* mName;
+    /// Slot of the variable, set by bind().
+    const AstSym* mSym;
 };
 
 /**
@@ -206,13 +341,9 @@ public:
      *   The index expression.
      */
     AstArrExprNode(
-        const char* name,
+        const Ident* name,
         AstExprNode* index
         );
-    /**
-     * @brief Frees the index expression.
-     */
-    ~AstArrExprNode();
 
     /**
      * @brief Prints the node to a file.
@@ -226,6 +357,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -233,8 +376,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -243,13 +384,35 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node to use instead.
+     */
+    AstExprNode* foldConst( AstFold& fold );
 
 protected:
     /// Name of the referenced array.
-    std::string mName;
+    const Ident* mName;
+    /// Slot of the array, set by bind().
+    const AstSym* mSym;
     /// The index expression.
     AstExprNode* mIndex;
 };
@@ -268,12 +431,13 @@ public:
      *
      * @param[in] name
      *   Name of the called function.
+     * @param[in] arena
+     *   The arena to allocate arguments from.
      */
-    AstFunExprNode( const char* name );
-    /**
-     * @brief Frees the argument expressions.
-     */
-    ~AstFunExprNode();
+    AstFunExprNode(
+        const Ident* name,
+        AstArena& arena
+        );
 
     /**
      * @brief Adds an argument to the call.
@@ -295,6 +459,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -302,8 +478,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -312,15 +486,64 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node to use instead.
+     */
+    AstExprNode* foldConst( AstFold& fold );
+
+    /**
+     * @brief Passes the arguments of a call.
+     *
+     * Arguments passed by reference are replaced by
+     * their addresses, so arrays are not copied.
+     *
+     * @param[in] loc
+     *   Location of the call.
+     * @param[in] fndecl
+     *   The called function.
+     * @param[in] argc
+     *   Count of the arguments.
+     * @param[in,out] argv
+     *   The translated arguments.
+     *
+     * @retval true
+     *   The arguments match the declaration.
+     * @retval false
+     *   The arguments do not match the declaration.
+     */
+    static bool buildArgs(
+        location_t loc,
+        tree fndecl,
+        unsigned int argc,
+        tree* argv
+        );
 
 protected:
     /// Name of the called function.
-    std::string mName;
+    const Ident* mName;
+    /// Slot of the function, set by bind().
+    const AstSym* mSym;
     /// An argument vector.
-    std::vector< AstExprNode* > mArgs;
+    AstList< AstExprNode* > mArgs;
 };
 
 /**
@@ -344,10 +567,6 @@ public:
         LexToken token,
         AstExprNode* op
         );
-    /**
-     * @brief Frees the operand.
-     */
-    ~AstUnopExprNode();
 
     /**
      * @brief Prints the node to a file.
@@ -361,6 +580,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -368,8 +599,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -378,9 +607,53 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node to use instead.
+     */
+    AstExprNode* foldConst( AstFold& fold );
+
+    /**
+     * @brief Builds the tree of an unary operation.
+     *
+     * @param[in] loc
+     *   Location of the operation.
+     * @param[in] token
+     *   The operator.
+     * @param[in] op
+     *   The translated operand.
+     * @param[out] t
+     *   The operation.
+     *
+     * @retval true
+     *   The operator is known.
+     * @retval false
+     *   The operator is not known.
+     */
+    static bool buildOp(
+        location_t loc,
+        LexToken token,
+        tree op,
+        tree& t
+        );
 
 protected:
     /// Equivalent lexical token.
@@ -413,10 +686,6 @@ public:
         AstExprNode* left,
         AstExprNode* right
         );
-    /**
-     * @brief Frees both operands.
-     */
-    ~AstBinopExprNode();
 
     /**
      * @brief Prints the node to a file.
@@ -430,6 +699,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -437,8 +718,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -447,11 +726,84 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node to use instead.
+     */
+    AstExprNode* foldConst( AstFold& fold );
+    /**
+     * @brief Folds constant operations in a function argument.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node to use instead.
+     */
+    AstExprNode* foldConstArg( AstFold& fold );
+
+    /**
+     * @brief Builds the tree of a binary operation.
+     *
+     * @param[in] loc
+     *   Location of the operation.
+     * @param[in] token
+     *   The operator.
+     * @param[in] left
+     *   The translated left operand.
+     * @param[in] right
+     *   The translated right operand.
+     * @param[out] t
+     *   The operation.
+     *
+     * @retval true
+     *   The operator is known.
+     * @retval false
+     *   The operator is not known.
+     */
+    static bool buildOp(
+        location_t loc,
+        LexToken token,
+        tree left,
+        tree right,
+        tree& t
+        );
 
 protected:
+    /**
+     * @brief Folds the operation.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     * @param[in] neutral
+     *   Whether a neutral operand may be dropped.
+     *
+     * @return
+     *   The node to use instead.
+     */
+    AstExprNode* foldOps(
+        AstFold& fold,
+        bool neutral
+        );
+
     /// Equivalent lexical token.
     LexToken mToken;
     /// Left operand.
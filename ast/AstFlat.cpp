@@ -0,0 +1,700 @@
+/** @file
+ * @brief Definition of the flat AST.
+ *
+ * @author Jan Bobek
+ * @since 16th October 2026
+ */
+
+#include "sfe-lang.h"
+#include "ast/AstDeclNode.hpp"
+#include "ast/AstFlat.hpp"
+#include "ast/AstLib.hpp"
+#include "ast/AstStmtNode.hpp"
+#include "parser/SymTable.hpp"
+
+/*************************************************************************/
+/* AstFlat                                                               */
+/*************************************************************************/
+AstFlat::AstFlat(
+    const AstNode& ast
+    )
+{
+    ast.flatten( *this );
+    mNameIdx.clear();
+}
+
+uint32_t
+AstFlat::addNode(
+    AstFlatKind kind,
+    location_t loc,
+    LexToken token,
+    uint32_t op0,
+    uint32_t op1,
+    uint32_t op2
+    )
+{
+    AstFlatNode node;
+    node.kind = static_cast< uint8_t >( kind );
+    node.token = static_cast< uint8_t >( token );
+    node.loc = loc;
+    node.op[0] = op0;
+    node.op[1] = op1;
+    node.op[2] = op2;
+
+    mNodes.push_back( node );
+    return mNodes.size() - 1;
+}
+
+uint32_t
+AstFlat::addName(
+    const Ident* name
+    )
+{
+    std::pair< std::map< const Ident*, uint32_t >::iterator, bool > res =
+        mNameIdx.insert( std::make_pair( name, mNames.size() ) );
+
+    if( res.second )
+        mNames.push_back( name );
+
+    return res.first->second;
+}
+
+uint32_t
+AstFlat::addStr(
+    const LexStr& str
+    )
+{
+    uint32_t off = mChars.size();
+    mChars.insert( mChars.end(), str.str, str.str + str.len );
+    mChars.push_back( '\0' );
+
+    return off;
+}
+
+uint32_t
+AstFlat::addList(
+    const std::vector< uint32_t >& items
+    )
+{
+    uint32_t first = mLists.size();
+    mLists.insert( mLists.end(), items.begin(), items.end() );
+
+    return first;
+}
+
+size_t
+AstFlat::size() const
+{
+    return mNodes.size();
+}
+
+size_t
+AstFlat::usedBytes() const
+{
+    return mNodes.size() * sizeof(AstFlatNode)
+        + mLists.size() * sizeof(uint32_t)
+        + mNames.size() * sizeof(const Ident*)
+        + mChars.size();
+}
+
+bool
+AstFlat::translate() const
+{
+    if( mNodes.empty() )
+        return false;
+
+    tree t;
+    SymTable symTable;
+    mSyms.clear();
+    return translate( mNodes.size() - 1, t, NULL_TREE, symTable );
+}
+
+bool
+AstFlat::translate(
+    uint32_t idx,
+    tree& t,
+    tree ctx,
+    SymTable& symTable
+    ) const
+{
+    const AstFlatNode& node = mNodes[idx];
+
+    switch( node.kind )
+    {
+    case ASTFLAT_INT_EXPR:
+        t = build_int_cst(
+            integer_type_node,
+            static_cast< int >( node.op[0] ) );
+        return true;
+
+    case ASTFLAT_STR_EXPR:
+        t = AstLib::global().getStr(
+            &mChars[node.op[0]], node.op[1] );
+        return true;
+
+    case ASTFLAT_VAR_EXPR:
+    {
+        const AstSym* sym =
+            symTable.getVar( mNames[node.op[0]] );
+
+        if( NULL == sym )
+        {
+            fprintf( stderr, "Unknown variable `%s'\n",
+                     mNames[node.op[0]]->str );
+            return false;
+        }
+
+        t = astDeref( sym->decl );
+        return true;
+    }
+
+    case ASTFLAT_ARR_EXPR:
+    {
+        const AstSym* sym =
+            symTable.getArr( mNames[node.op[0]] );
+
+        if( NULL == sym )
+        {
+            fprintf( stderr, "Unknown array `%s'\n",
+                     mNames[node.op[0]]->str );
+            return false;
+        }
+
+        tree array = astDeref( sym->decl );
+        int off = sym->off;
+
+        tree index;
+        if( !translate( node.op[1], index, ctx, symTable ) )
+            return false;
+
+        if( 0 < off )
+            index = build2_loc(
+                node.loc, PLUS_EXPR, TREE_TYPE( index ), index,
+                build_int_cst( integer_type_node, off ) );
+        else if( 0 > off )
+            index = build2_loc(
+                node.loc, MINUS_EXPR, TREE_TYPE( index ), index,
+                build_int_cst( integer_type_node, -off ) );
+
+        t = build4_loc(
+            node.loc, ARRAY_REF, TREE_TYPE( TREE_TYPE( array ) ),
+            array, index, NULL_TREE, NULL_TREE );
+        return true;
+    }
+
+    case ASTFLAT_FUN_EXPR:
+    {
+        const AstSym* sym =
+            symTable.getFun( mNames[node.op[0]] );
+
+        if( NULL == sym )
+        {
+            fprintf( stderr, "Unknown function `%s'\n",
+                     mNames[node.op[0]]->str );
+            return false;
+        }
+
+        tree fndecl = sym->decl;
+
+        const uint32_t* items = &mLists[node.op[1]];
+        std::vector< tree > args( node.op[2] );
+        for( unsigned int i = 0; i < node.op[2]; ++i )
+            if( !translateArg( items[i], args[i], ctx, symTable ) )
+                return false;
+
+        tree* argv = (args.empty() ? NULL : &args[0]);
+
+        if( !AstFunExprNode::buildArgs(
+                node.loc, fndecl, node.op[2], argv ) )
+            return false;
+
+        t = build_call_expr_loc_array(
+            node.loc, fndecl,
+            node.op[2], argv );
+        SET_EXPR_LOCATION( t, node.loc );
+        TREE_USED( t ) = true;
+        return true;
+    }
+
+    case ASTFLAT_UNOP_EXPR:
+    {
+        tree op;
+        if( !translate( node.op[0], op, ctx, symTable ) )
+            return false;
+
+        return AstUnopExprNode::buildOp(
+            node.loc, static_cast< LexToken >( node.token ), op, t );
+    }
+
+    case ASTFLAT_BINOP_EXPR:
+    {
+        tree left, right;
+        if( !translate( node.op[0], left, ctx, symTable ) ||
+            !translate( node.op[1], right, ctx, symTable ) )
+            return false;
+
+        return AstBinopExprNode::buildOp(
+            node.loc, static_cast< LexToken >( node.token ),
+            left, right, t );
+    }
+
+    case ASTFLAT_BINOP_STMT:
+    {
+        tree lval, rval;
+        if( !translate( node.op[0], lval, ctx, symTable ) ||
+            !translate( node.op[1], rval, ctx, symTable ) ||
+            !astWritable( lval ) )
+            return false;
+
+        switch( node.token )
+        {
+        case LEXTOK_ASSGN: t = build2_loc( node.loc, MODIFY_EXPR, TREE_TYPE( lval ), lval, rval ); return true;
+
+        case LEXTOK_KW_INC: t = build2_loc( node.loc, PREINCREMENT_EXPR, TREE_TYPE( lval ), lval, rval ); return true;
+        case LEXTOK_KW_DEC: t = build2_loc( node.loc, PREDECREMENT_EXPR, TREE_TYPE( lval ), lval, rval ); return true;
+
+        default: return false;
+        }
+    }
+
+    case ASTFLAT_BLK_STMT:
+        return translateBlk( node, t, ctx, symTable );
+
+    case ASTFLAT_IF_STMT:
+    {
+        tree cond, thenBlk, elseBlk;
+        if( !translate( node.op[0], cond, ctx, symTable ) ||
+            !translate( node.op[1], thenBlk, ctx, symTable ) )
+            return false;
+
+        if( ASTFLAT_NONE == node.op[2] )
+            elseBlk = NULL_TREE;
+        else if( !translate( node.op[2], elseBlk, ctx, symTable ) )
+            return false;
+
+        t = build3_loc(
+            node.loc, COND_EXPR, void_type_node,
+            astTruthValue( node.loc, cond ), thenBlk, elseBlk );
+        return true;
+    }
+
+    case ASTFLAT_LOOP_STMT:
+    {
+        tree body;
+        if( !translate( node.op[0], body, ctx, symTable ) )
+            return false;
+
+        t = build1_loc( node.loc, LOOP_EXPR, void_type_node, body );
+        return true;
+    }
+
+    case ASTFLAT_FOR_STMT:
+    {
+        const uint32_t* list = &mLists[node.op[1]];
+
+        tree var, from, to, body;
+        if( !translate( node.op[0], var, ctx, symTable ) ||
+            !astWritable( var ) ||
+            !translate( list[0], from, ctx, symTable ) ||
+            !translate( list[1], to, ctx, symTable ) )
+            return false;
+
+        astLockControl( var, true );
+        bool translated = translate( list[2], body, ctx, symTable );
+        astLockControl( var, false );
+
+        if( !translated )
+            return false;
+
+        t = AstForStmtNode::buildLoop(
+            node.loc, static_cast< LexToken >( node.token ),
+            var, from, to, body );
+        return true;
+    }
+
+    case ASTFLAT_BREAK_STMT:
+    {
+        tree cond;
+        if( !translate( node.op[0], cond, ctx, symTable ) )
+            return false;
+
+        t = build1_loc(
+            node.loc, EXIT_EXPR, void_type_node,
+            astTruthValue( node.loc, cond ) );
+        return true;
+    }
+
+    case ASTFLAT_EXIT_STMT:
+    {
+        const AstSym* res = symTable.getRes();
+
+        t = build1_loc(
+            node.loc, RETURN_EXPR,
+            void_type_node,
+            (NULL == res ? NULL_TREE : res->decl) );
+        return true;
+    }
+
+    case ASTFLAT_READ_STMT:
+        return translateLib( node, "scanf", t, ctx, symTable );
+
+    case ASTFLAT_WRITE_STMT:
+        return translateLib( node, "printf", t, ctx, symTable );
+
+    case ASTFLAT_CONST_DECL:
+    {
+        // The value is translated before the name is visible.
+        const Ident* name = mNames[node.op[0]];
+        if( !translate( node.op[1], t, ctx, symTable ) ||
+            !AstConstDeclNode::foldVal( name->str, t ) )
+            return false;
+
+        return symTable.addVar( name, newSym( t ) );
+    }
+
+    case ASTFLAT_VAR_DECL:
+    {
+        const Ident* name = mNames[node.op[0]];
+
+        tree type;
+        if( !translate( node.op[1], type, NULL_TREE, symTable ) )
+            return false;
+
+        t = build_decl(
+            node.loc, VAR_DECL,
+            get_identifier( name->str ),
+            type );
+        TREE_ADDRESSABLE( t ) = true;
+        TREE_USED( t ) = true;
+
+        return addSym( node.op[1], name, t, symTable );
+    }
+
+    case ASTFLAT_FUN_DECL:
+        return translateFun( node, t, ctx, symTable );
+
+    case ASTFLAT_PROG_DECL:
+    {
+        const uint32_t* decls = &mLists[node.op[1]];
+        for( unsigned int i = 0; i < node.op[2]; ++i )
+        {
+            tree decl;
+            if( !translate( decls[i], decl, ctx, symTable ) )
+                return false;
+
+            const AstFlatNode& dnode = mNodes[decls[i]];
+            if( ASTFLAT_FUN_DECL != dnode.kind )
+            {
+                // Constants are substituted at their uses.
+                if( VAR_DECL == TREE_CODE( decl ) )
+                {
+                    TREE_STATIC( decl ) = true;
+                    register_global_variable_declaration( decl );
+                }
+            }
+            // The body follows the result type in the list.
+            else if( ASTFLAT_NONE != mLists[dnode.op[1] + 1] )
+                register_global_function_declaration( decl );
+        }
+
+        t = NULL_TREE;
+        return true;
+    }
+
+    case ASTFLAT_INT_TYPE:
+        t = integer_type_node;
+        return true;
+
+    case ASTFLAT_ARR_TYPE:
+    {
+        tree elemType;
+        if( !translate( node.op[2], elemType, ctx, symTable ) )
+            return false;
+
+        t = build_array_type(
+            elemType,
+            build_index_type(
+                size_int( static_cast< int >( node.op[1] )
+                          - static_cast< int >( node.op[0] ) ) ) );
+        return true;
+    }
+
+    default:
+        t = NULL_TREE;
+        return false;
+    }
+}
+
+bool
+AstFlat::translateArg(
+    uint32_t idx,
+    tree& t,
+    tree ctx,
+    SymTable& symTable
+    ) const
+{
+    const AstFlatNode& node = mNodes[idx];
+    if( ASTFLAT_VAR_EXPR != node.kind )
+        return translate( idx, t, ctx, symTable );
+
+    const AstSym* sym =
+        symTable.getVar( mNames[node.op[0]] );
+
+    if( NULL == sym )
+        sym = symTable.getArr( mNames[node.op[0]] );
+
+    if( NULL == sym )
+    {
+        fprintf( stderr, "Unknown variable `%s'\n",
+                 mNames[node.op[0]]->str );
+        return false;
+    }
+
+    t = astDeref( sym->decl );
+    return true;
+}
+
+bool
+AstFlat::translateBlk(
+    const AstFlatNode& node,
+    tree& t,
+    tree ctx,
+    SymTable& symTable
+    ) const
+{
+    tree decls = NULL_TREE;
+    tree stmts = alloc_stmt_list();
+    SymScope scope( symTable );
+
+    const uint32_t* cur = &mLists[node.op[0]];
+    const uint32_t* end = cur + node.op[1];
+    for(; cur != end; ++cur )
+    {
+        tree decl;
+        if( !translate( *cur, decl, ctx, symTable ) )
+            return false;
+
+        // Constants are substituted at their uses.
+        if( INTEGER_CST == TREE_CODE( decl ) )
+            continue;
+
+        decls = chainon( decls, decl );
+        append_to_statement_list(
+            build1_loc(
+                DECL_SOURCE_LOCATION( decl ),
+                DECL_EXPR, void_type_node, decl ),
+            &stmts );
+    }
+
+    tree block = build_block(
+        decls, NULL_TREE, NULL_TREE, NULL_TREE );
+    TREE_USED( block ) = true;
+
+    end = cur + node.op[2];
+    for(; cur != end; ++cur )
+    {
+        tree stmt;
+        if( !translate( *cur, stmt, block, symTable ) )
+            return false;
+
+        append_to_statement_list( stmt, &stmts );
+    }
+
+    t = build3_loc(
+        node.loc, BIND_EXPR, void_type_node,
+        BLOCK_VARS( block ), stmts, block );
+    TREE_SIDE_EFFECTS( t ) = true;
+
+    BLOCK_SUPERCONTEXT( block ) = ctx;
+    if( NULL_TREE != ctx && BLOCK == TREE_CODE( ctx ) )
+    {
+        tree* pp = &BLOCK_SUBBLOCKS( ctx );
+        while( NULL_TREE != *pp )
+            pp = &BLOCK_CHAIN( *pp );
+        *pp = block;
+    }
+
+    return true;
+}
+
+bool
+AstFlat::translateLib(
+    const AstFlatNode& node,
+    const char* name,
+    tree& t,
+    tree ctx,
+    SymTable& symTable
+    ) const
+{
+    tree fmt, expr;
+    if( !translate( node.op[0], fmt, ctx, symTable ) ||
+        !translate( node.op[1], expr, ctx, symTable ) )
+        return false;
+
+    // Read takes the address of the variable.
+    if( ASTFLAT_READ_STMT == node.kind )
+    {
+        if( !astWritable( expr ) )
+            return false;
+
+        expr = build_fold_addr_expr_loc( node.loc, expr );
+    }
+
+    tree args[2] = { fmt, expr };
+
+    t = build_call_expr_loc_array(
+        node.loc,
+        AstLib::global().getFun( name ),
+        2, args );
+    SET_EXPR_LOCATION( t, node.loc );
+    TREE_USED( t ) = true;
+
+    return true;
+}
+
+bool
+AstFlat::translateFun(
+    const AstFlatNode& node,
+    tree& t,
+    tree ctx,
+    SymTable& symTable
+    ) const
+{
+    const Ident* name = mNames[node.op[0]];
+    const uint32_t* list = &mLists[node.op[1]];
+    const uint32_t resType = list[0];
+    const uint32_t body = list[1];
+    const uint32_t* args = list + 2;
+    const uint32_t* argsEnd = args + 3 * node.op[2];
+
+    const AstSym* sym = symTable.getFun( name );
+
+    if( NULL != sym )
+        t = sym->decl;
+    else
+    {
+        tree params = NULL_TREE;
+        tree params_decl = NULL_TREE;
+
+        for( const uint32_t* cur = args; cur != argsEnd; cur += 3 )
+        {
+            tree param;
+            if( !translate( cur[1], param, ctx, symTable ) )
+                return false;
+
+            tree param_decl =
+                AstFunDeclNode::buildParam(
+                    node.loc,
+                    mNames[cur[0]]->str,
+                    static_cast< LexToken >( cur[2] ),
+                    param );
+
+            params = chainon(
+                params,
+                tree_cons(
+                    NULL_TREE,
+                    DECL_ARG_TYPE( param_decl ),
+                    NULL_TREE ) );
+            params_decl = chainon(
+                params_decl,
+                param_decl );
+        }
+
+        tree restype;
+        if( ASTFLAT_NONE == resType )
+            restype = void_type_node;
+        else if( !translate( resType, restype, ctx, symTable ) )
+            return false;
+
+        tree resdecl =
+            build_decl(
+                BUILTINS_LOCATION,
+                RESULT_DECL,
+                NULL_TREE,
+                restype );
+        tree fntype =
+            build_function_type(
+                TREE_TYPE( resdecl ),
+                params );
+
+        t = build_decl(
+            node.loc,
+            FUNCTION_DECL,
+            get_identifier( name->str ),
+            fntype );
+        DECL_ARGUMENTS( t ) = params_decl;
+        DECL_RESULT( t ) = resdecl;
+        TREE_STATIC( t ) = true;
+        TREE_PUBLIC( t ) = true;
+
+        if( !symTable.addFun( name, newSym( t ) ) )
+            return false;
+    }
+
+    if( ASTFLAT_NONE != body )
+    {
+        if( NULL_TREE != DECL_SAVED_TREE( t ) )
+        {
+            fprintf( stderr, "Function `%s' defined more than once\n",
+                     name->str );
+            return false;
+        }
+
+        SymScope scope( symTable );
+
+        tree resdecl = DECL_RESULT( t );
+        if( ASTFLAT_NONE != resType &&
+            (!symTable.setRes( newSym( resdecl ) ) ||
+             !addSym( resType, name, resdecl, symTable )) )
+            return false;
+
+        tree params_decl = DECL_ARGUMENTS( t );
+        for( const uint32_t* cur = args; cur != argsEnd; cur += 3 )
+        {
+            if( !addSym( cur[1], mNames[cur[0]],
+                         params_decl, symTable ) )
+                return false;
+
+            params_decl = TREE_CHAIN( params_decl );
+        }
+
+        tree bind;
+        if( !translate( body, bind, t, symTable ) )
+            return false;
+
+        tree block =
+            TREE_OPERAND( bind, 2 );
+
+        DECL_INITIAL( t ) = block;
+        DECL_SAVED_TREE( t ) = bind;
+    }
+
+    return true;
+}
+
+bool
+AstFlat::addSym(
+    uint32_t type,
+    const Ident* name,
+    tree decl,
+    SymTable& symTable
+    ) const
+{
+    const AstFlatNode& node = mNodes[type];
+    if( ASTFLAT_ARR_TYPE != node.kind )
+        return symTable.addVar( name, newSym( decl ) );
+
+    AstSym* sym = newSym( decl );
+    sym->off = -static_cast< int >( node.op[0] );
+    return symTable.addArr( name, sym );
+}
+
+AstSym*
+AstFlat::newSym(
+    tree decl
+    ) const
+{
+    AstSym sym = { decl, 0 };
+    mSyms.push_back( sym );
+    return &mSyms.back();
+}
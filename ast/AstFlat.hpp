@@ -0,0 +1,356 @@
+/** @file
+ * @brief Declaration of the flat AST.
+ *
+ * @author Jan Bobek
+ * @since 16th October 2026
+ */
+
+#ifndef SFE__AST__AST_FLAT_HPP__INCL__
+#define SFE__AST__AST_FLAT_HPP__INCL__
+
+#include <stdint.h>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "ast/AstNode.hpp"
+#include "parser/LexAnalyzer.hpp"
+
+/**
+ * @brief Kinds of the flat AST nodes.
+ *
+ * The comments list the operands of the node;
+ * all the lists are stored in AstFlat::mLists.
+ *
+ * @author Jan Bobek
+ */
+enum AstFlatKind
+{
+    ASTFLAT_INT_EXPR,   ///< Value.
+    ASTFLAT_STR_EXPR,   ///< Offset, length.
+    ASTFLAT_VAR_EXPR,   ///< Name.
+    ASTFLAT_ARR_EXPR,   ///< Name, index.
+    ASTFLAT_FUN_EXPR,   ///< Name, list of arguments, count.
+    ASTFLAT_UNOP_EXPR,  ///< Operand.
+    ASTFLAT_BINOP_EXPR, ///< Left, right.
+
+    ASTFLAT_BINOP_STMT, ///< Left, right.
+    ASTFLAT_BLK_STMT,   ///< List of declarations and statements, counts of both.
+    ASTFLAT_IF_STMT,    ///< Condition, then, else or ASTFLAT_NONE.
+    ASTFLAT_LOOP_STMT,  ///< Body.
+    ASTFLAT_FOR_STMT,   ///< Control variable, list of initial value,
+                        ///< final value and body.
+    ASTFLAT_BREAK_STMT, ///< Condition.
+    ASTFLAT_EXIT_STMT,  ///< Nothing.
+    ASTFLAT_READ_STMT,  ///< Format, expression.
+    ASTFLAT_WRITE_STMT, ///< Format, expression.
+
+    ASTFLAT_CONST_DECL, ///< Name, value expression.
+    ASTFLAT_VAR_DECL,   ///< Name, type.
+    ASTFLAT_FUN_DECL,   ///< Name, list of result type, body and argument
+                        ///< name/type/mode triples, count of arguments.
+    ASTFLAT_PROG_DECL,  ///< Name, list of globals and functions, count.
+
+    ASTFLAT_INT_TYPE,   ///< Nothing.
+    ASTFLAT_ARR_TYPE    ///< Begin, end, element type.
+};
+
+/// Index of an absent node.
+static const uint32_t ASTFLAT_NONE = 0xFFFFFFFF;
+
+/**
+ * @brief A node of the flat AST.
+ *
+ * @author Jan Bobek
+ */
+struct AstFlatNode
+{
+    /// Kind of the node, an AstFlatKind.
+    uint8_t kind;
+    /// The operator token, a LexToken.
+    uint8_t token;
+    /// The operands; meaning depends on the kind.
+    uint32_t op[3];
+    /// Source location of the node.
+    location_t loc;
+};
+
+/**
+ * @brief The AST encoded in contiguous arrays.
+ *
+ * Nodes refer to each other by 32-bit indices, names
+ * are indices into a table of interned identifiers and
+ * strings are copied in, so the flat AST survives the
+ * arena it was flattened from. Children precede their
+ * parents, hence the root is the last node.
+ *
+ * @author Jan Bobek
+ */
+class AstFlat
+{
+public:
+    /**
+     * @brief Flattens an AST.
+     *
+     * @param[in] ast
+     *   The AST to flatten.
+     */
+    AstFlat( const AstNode& ast );
+
+    /**
+     * @brief Appends a node.
+     *
+     * @param[in] kind
+     *   Kind of the node.
+     * @param[in] loc
+     *   Source location of the node.
+     * @param[in] token
+     *   The operator token.
+     * @param[in] op0
+     *   The first operand.
+     * @param[in] op1
+     *   The second operand.
+     * @param[in] op2
+     *   The third operand.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t addNode(
+        AstFlatKind kind,
+        location_t loc,
+        LexToken token = LEXTOK_EOI,
+        uint32_t op0 = ASTFLAT_NONE,
+        uint32_t op1 = ASTFLAT_NONE,
+        uint32_t op2 = ASTFLAT_NONE
+        );
+    /**
+     * @brief Interns a name.
+     *
+     * @param[in] name
+     *   The name.
+     *
+     * @return
+     *   Index of the name.
+     */
+    uint32_t addName( const Ident* name );
+    /**
+     * @brief Copies a string in.
+     *
+     * @param[in] str
+     *   The string.
+     *
+     * @return
+     *   Offset of the copy, terminated by NUL.
+     */
+    uint32_t addStr( const LexStr& str );
+    /**
+     * @brief Appends a list.
+     *
+     * @param[in] items
+     *   Items of the list.
+     *
+     * @return
+     *   Index of the first item.
+     */
+    uint32_t addList( const std::vector< uint32_t >& items );
+
+    /**
+     * @brief Obtains the number of nodes.
+     *
+     * @return
+     *   Number of nodes.
+     */
+    size_t size() const;
+    /**
+     * @brief Obtains the size of the encoding.
+     *
+     * @return
+     *   Number of bytes of all the arrays.
+     */
+    size_t usedBytes() const;
+
+    /**
+     * @brief Translates the AST into equivalent GENERIC tree.
+     *
+     * Behaves exactly like AstNode::translate().
+     *
+     * @retval true
+     *   Translation successful.
+     * @retval false
+     *   Translation failed.
+     */
+    bool translate() const;
+
+protected:
+    /**
+     * @brief Translates a node into equivalent GENERIC tree.
+     *
+     * @param[in] idx
+     *   Index of the node.
+     * @param[out] t
+     *   Where to store the translated tree.
+     * @param[in,out] ctx
+     *   Context in which the node appears.
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   Translation successful.
+     * @retval false
+     *   Translation failed.
+     */
+    bool translate(
+        uint32_t idx,
+        tree& t,
+        tree ctx,
+        SymTable& symTable
+        ) const;
+    /**
+     * @brief Translates a function argument.
+     *
+     * Unlike elsewhere, a whole array may be
+     * passed as an argument.
+     *
+     * @param[in] idx
+     *   Index of the argument node.
+     * @param[out] t
+     *   Where to store the translated tree.
+     * @param[in,out] ctx
+     *   Context in which the node appears.
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   Translation successful.
+     * @retval false
+     *   Translation failed.
+     */
+    bool translateArg(
+        uint32_t idx,
+        tree& t,
+        tree ctx,
+        SymTable& symTable
+        ) const;
+    /**
+     * @brief Translates a block statement.
+     *
+     * @param[in] node
+     *   The block node.
+     * @param[out] t
+     *   Where to store the translated tree.
+     * @param[in,out] ctx
+     *   Context in which the node appears.
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   Translation successful.
+     * @retval false
+     *   Translation failed.
+     */
+    bool translateBlk(
+        const AstFlatNode& node,
+        tree& t,
+        tree ctx,
+        SymTable& symTable
+        ) const;
+    /**
+     * @brief Translates a call to a library function.
+     *
+     * @param[in] node
+     *   The read or write node.
+     * @param[in] name
+     *   Name of the library function.
+     * @param[out] t
+     *   Where to store the translated tree.
+     * @param[in,out] ctx
+     *   Context in which the node appears.
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   Translation successful.
+     * @retval false
+     *   Translation failed.
+     */
+    bool translateLib(
+        const AstFlatNode& node,
+        const char* name,
+        tree& t,
+        tree ctx,
+        SymTable& symTable
+        ) const;
+    /**
+     * @brief Translates a function declaration.
+     *
+     * @param[in] node
+     *   The function node.
+     * @param[out] t
+     *   Where to store the translated tree.
+     * @param[in,out] ctx
+     *   Context in which the node appears.
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   Translation successful.
+     * @retval false
+     *   Translation failed.
+     */
+    bool translateFun(
+        const AstFlatNode& node,
+        tree& t,
+        tree ctx,
+        SymTable& symTable
+        ) const;
+
+    /**
+     * @brief Registers a symbol according to a type.
+     *
+     * @param[in] type
+     *   Index of the type node.
+     * @param[in] name
+     *   Name of the symbol.
+     * @param[in] decl
+     *   Declaration of the symbol.
+     * @param[in] symTable
+     *   The SymTable to use.
+     *
+     * @return
+     *   Whatever returned by SymTable.
+     */
+    bool addSym(
+        uint32_t type,
+        const Ident* name,
+        tree decl,
+        SymTable& symTable
+        ) const;
+    /**
+     * @brief Creates a declaration slot.
+     *
+     * @param[in] decl
+     *   Declaration of the symbol.
+     *
+     * @return
+     *   The slot, valid until the next translation.
+     */
+    AstSym* newSym( tree decl ) const;
+
+    /// The nodes.
+    std::vector< AstFlatNode > mNodes;
+    /// Items of all the lists.
+    std::vector< uint32_t > mLists;
+    /// The interned names.
+    std::vector< const Ident* > mNames;
+    /// Characters of all the strings.
+    std::vector< char > mChars;
+
+    /// Indices of the names, used while flattening.
+    std::map< const Ident*, uint32_t > mNameIdx;
+    /// Slots of the declarations, used while translating.
+    mutable std::deque< AstSym > mSyms;
+};
+
+#endif /* !SFE__AST__AST_FLAT_HPP__INCL__ */
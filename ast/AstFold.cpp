@@ -0,0 +1,129 @@
+/** @file
+ * @brief Definition of the AST folding pass.
+ *
+ * @author Jan Bobek
+ * @since 16th October 2026
+ */
+
+#include <climits>
+
+#include "ast/AstExprNode.hpp"
+#include "ast/AstFold.hpp"
+
+/*************************************************************************/
+/* AstFold                                                               */
+/*************************************************************************/
+AstFold::AstFold(
+    AstArena& arena
+    )
+: mArena( arena ),
+  mFolded( 0 )
+{
+}
+
+AstExprNode*
+AstFold::foldInt(
+    location_t loc,
+    int val
+    )
+{
+    AstExprNode* expr = new( mArena ) AstIntExprNode( val );
+    expr->setLoc( loc );
+
+    ++mFolded;
+    return expr;
+}
+
+AstExprNode*
+AstFold::foldTo(
+    AstExprNode* expr
+    )
+{
+    ++mFolded;
+    return expr;
+}
+
+unsigned long
+AstFold::folded() const
+{
+    return mFolded;
+}
+
+bool
+AstFold::evalUnop(
+    LexToken token,
+    int op,
+    int& val
+    )
+{
+    switch( token )
+    {
+    case LEXTOK_MINUS:
+        if( INT_MIN == op )
+            return false;
+
+        val = -op;
+        return true;
+
+    case LEXTOK_NOT:
+        val = !op;
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+bool
+AstFold::evalBinop(
+    LexToken token,
+    int left,
+    int right,
+    int& val
+    )
+{
+    // Wide enough for the product of any two integers.
+    int64_t res;
+
+    switch( token )
+    {
+    case LEXTOK_PLUS:  res = static_cast< int64_t >( left ) + right; break;
+    case LEXTOK_MINUS: res = static_cast< int64_t >( left ) - right; break;
+    case LEXTOK_MULT:  res = static_cast< int64_t >( left ) * right; break;
+
+    // Both truncate; INT_MIN div -1 overflows and
+    // INT_MIN mod -1 traps just as well.
+    case LEXTOK_DIV:
+        if( 0 == right || (INT_MIN == left && -1 == right) )
+            return false;
+
+        res = left / right;
+        break;
+    case LEXTOK_MOD:
+        if( 0 == right || (INT_MIN == left && -1 == right) )
+            return false;
+
+        res = left % right;
+        break;
+
+    case LEXTOK_EQ:  res = (left == right); break;
+    case LEXTOK_NEQ: res = (left != right); break;
+    case LEXTOK_LT:  res = (left <  right); break;
+    case LEXTOK_LEQ: res = (left <= right); break;
+    case LEXTOK_GT:  res = (left >  right); break;
+    case LEXTOK_GEQ: res = (left >= right); break;
+
+    // Constant operands have no side effects to skip.
+    case LEXTOK_OR:  res = (left || right); break;
+    case LEXTOK_AND: res = (left && right); break;
+
+    default:
+        return false;
+    }
+
+    if( res < INT_MIN || INT_MAX < res )
+        return false;
+
+    val = static_cast< int >( res );
+    return true;
+}
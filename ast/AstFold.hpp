@@ -0,0 +1,127 @@
+/** @file
+ * @brief Declaration of the AST folding pass.
+ *
+ * @author Jan Bobek
+ * @since 16th October 2026
+ */
+
+#ifndef SFE__AST__AST_FOLD_HPP__INCL__
+#define SFE__AST__AST_FOLD_HPP__INCL__
+
+#include "ast/AstArena.hpp"
+#include "ast/AstNode.hpp"
+#include "parser/LexAnalyzer.hpp"
+
+class AstExprNode;
+
+/**
+ * @brief State of the AST folding pass.
+ *
+ * The pass replaces operations on constants by their
+ * values and drops neutral operands, so that smaller
+ * trees are flattened and translated. It runs before
+ * binding, hence it knows no names; constants declared
+ * by name are substituted by the translation.
+ *
+ * @author Jan Bobek
+ */
+class AstFold
+{
+public:
+    /**
+     * @brief Initializes the pass.
+     *
+     * @param[in] arena
+     *   The arena of the AST to fold.
+     */
+    AstFold( AstArena& arena );
+
+    /**
+     * @brief Builds the value of a folded operation.
+     *
+     * @param[in] loc
+     *   Location of the operation.
+     * @param[in] val
+     *   The value.
+     *
+     * @return
+     *   The constant node.
+     */
+    AstExprNode* foldInt(
+        location_t loc,
+        int val
+        );
+    /**
+     * @brief Replaces an operation by its operand.
+     *
+     * @param[in] expr
+     *   The operand to keep.
+     *
+     * @return
+     *   The operand.
+     */
+    AstExprNode* foldTo( AstExprNode* expr );
+
+    /**
+     * @brief Number of the operations folded so far.
+     *
+     * @return
+     *   The number of nodes.
+     */
+    unsigned long folded() const;
+
+    /**
+     * @brief Evaluates an unary operation.
+     *
+     * @param[in] token
+     *   The operator.
+     * @param[in] op
+     *   The operand.
+     * @param[out] val
+     *   The result.
+     *
+     * @retval true
+     *   The result is defined.
+     * @retval false
+     *   The operation overflows.
+     */
+    static bool evalUnop(
+        LexToken token,
+        int op,
+        int& val
+        );
+    /**
+     * @brief Evaluates a binary operation.
+     *
+     * Signed overflow is undefined and division by zero
+     * traps, so such operations are left to run time.
+     *
+     * @param[in] token
+     *   The operator.
+     * @param[in] left
+     *   The left operand.
+     * @param[in] right
+     *   The right operand.
+     * @param[out] val
+     *   The result.
+     *
+     * @retval true
+     *   The result is defined.
+     * @retval false
+     *   The operation overflows or divides by zero.
+     */
+    static bool evalBinop(
+        LexToken token,
+        int left,
+        int right,
+        int& val
+        );
+
+protected:
+    /// The arena of the AST.
+    AstArena& mArena;
+    /// Number of the operations folded.
+    unsigned long mFolded;
+};
+
+#endif /* !SFE__AST__AST_FOLD_HPP__INCL__ */
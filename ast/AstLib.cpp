@@ -0,0 +1,86 @@
+/** @file
+ * @brief Definition of the library tree cache.
+ *
+ * @author Jan Bobek
+ * @since 16th October 2026
+ */
+
+#include "sfe-lang.h"
+#include "ast/AstLib.hpp"
+
+/*************************************************************************/
+/* AstLib                                                                */
+/*************************************************************************/
+AstLib&
+AstLib::global()
+{
+    static AstLib lib;
+    return lib;
+}
+
+tree
+AstLib::getFun(
+    const char* name
+    )
+{
+    TreeMap::iterator cur = mFuns.find( name );
+    if( mFuns.end() != cur )
+        return cur->second;
+
+    tree resdecl = build_decl(
+        BUILTINS_LOCATION, RESULT_DECL,
+        NULL_TREE, integer_type_node );
+    DECL_ARTIFICIAL( resdecl ) = true;
+    DECL_IGNORED_P( resdecl ) = true;
+
+    tree fntype = build_function_type(
+        TREE_TYPE( resdecl ), NULL_TREE );
+    tree fndecl = build_decl(
+        UNKNOWN_LOCATION, FUNCTION_DECL,
+        get_identifier( name ), fntype );
+    DECL_ARGUMENTS( fndecl ) = NULL_TREE;
+    DECL_RESULT( fndecl ) = resdecl;
+    DECL_EXTERNAL( fndecl ) = true;
+
+    register_global_tree( fndecl );
+    mFuns.insert( std::make_pair( name, fndecl ) );
+
+    return fndecl;
+}
+
+tree
+AstLib::getStr(
+    const char* str,
+    size_t len
+    )
+{
+    std::string key( str, len );
+    TreeMap::iterator cur = mStrs.find( key );
+
+    tree cst;
+    if( mStrs.end() != cur )
+        cst = cur->second;
+    else
+    {
+        tree idx_type = build_index_type(
+            size_int( len ) );
+        tree elem_type =
+            build_qualified_type(
+                unsigned_char_type_node,
+                TYPE_QUAL_CONST );
+        tree string_type =
+            build_array_type( elem_type, idx_type );
+        TYPE_STRING_FLAG( string_type ) = 1;
+
+        cst = build_string( len + 1, str );
+        TREE_TYPE( cst ) = string_type;
+
+        register_global_tree( cst );
+        mStrs.insert( std::make_pair( key, cst ) );
+    }
+
+    return build1(
+        ADDR_EXPR, build_pointer_type(
+            TREE_TYPE( cst ) ),
+        cst );
+}
@@ -0,0 +1,78 @@
+/** @file
+ * @brief Declaration of the library tree cache.
+ *
+ * @author Jan Bobek
+ * @since 16th October 2026
+ */
+
+#ifndef SFE__AST__AST_LIB_HPP__INCL__
+#define SFE__AST__AST_LIB_HPP__INCL__
+
+#include <cstddef>
+
+#include <map>
+#include <string>
+
+#include "ast/AstNode.hpp"
+
+/**
+ * @brief A cache of the trees shared by all call sites.
+ *
+ * The runtime library functions and the string constants
+ * are built on their first use only. Every cached tree is
+ * passed to register_global_tree(), so that the garbage
+ * collector keeps it alive between the functions.
+ *
+ * @author Jan Bobek
+ */
+class AstLib
+{
+public:
+    /**
+     * @brief Obtains the cache of the translation unit.
+     *
+     * @return
+     *   The global cache.
+     */
+    static AstLib& global();
+
+    /**
+     * @brief Obtains a declaration of a library function.
+     *
+     * The function returns an int and takes unspecified
+     * arguments, like printf and scanf do.
+     *
+     * @param[in] name
+     *   Name of the function.
+     *
+     * @return
+     *   The FUNCTION_DECL.
+     */
+    tree getFun( const char* name );
+    /**
+     * @brief Obtains the address of a string constant.
+     *
+     * Only the STRING_CST is shared; the ADDR_EXPR
+     * is built anew for every use.
+     *
+     * @param[in] str
+     *   The NUL-terminated string.
+     * @param[in] len
+     *   Length of the string.
+     *
+     * @return
+     *   The ADDR_EXPR of the string.
+     */
+    tree getStr( const char* str, size_t len );
+
+protected:
+    /// A map from names or contents to trees.
+    typedef std::map< std::string, tree > TreeMap;
+
+    /// The library function declarations.
+    TreeMap mFuns;
+    /// The string constants.
+    TreeMap mStrs;
+};
+
+#endif /* !SFE__AST__AST_LIB_HPP__INCL__ */
@@ -8,13 +8,156 @@
 #include "ast/AstNode.hpp"
 #include "parser/SymTable.hpp"
 
+/// Columns expected on a line of the source.
+static const unsigned int AST_LINE_COLUMNS = 80;
+
+location_t
+astLocation(
+    unsigned int line,
+    unsigned int col
+    )
+{
+#ifdef IN_GCC
+    linemap_line_start( line_table, line, AST_LINE_COLUMNS );
+    return linemap_position_for_column( line_table, col );
+#else /* !IN_GCC */
+    return UNKNOWN_LOCATION;
+#endif /* !IN_GCC */
+}
+
+tree
+astTruthValue(
+    location_t loc,
+    tree t
+    )
+{
+#ifdef IN_GCC
+    if( NOP_EXPR == TREE_CODE( t ) &&
+        BOOLEAN_TYPE == TREE_CODE( TREE_TYPE( TREE_OPERAND( t, 0 ) ) ) )
+        return TREE_OPERAND( t, 0 );
+
+    return build2_loc(
+        loc, NE_EXPR, boolean_type_node, t,
+        build_int_cst( TREE_TYPE( t ), 0 ) );
+#else /* !IN_GCC */
+    return t;
+#endif /* !IN_GCC */
+}
+
+tree
+astIntValue(
+    tree t
+    )
+{
+#ifdef IN_GCC
+    return build1( NOP_EXPR, integer_type_node, t );
+#else /* !IN_GCC */
+    return t;
+#endif /* !IN_GCC */
+}
+
+tree
+astDeref(
+    tree decl
+    )
+{
+#ifdef IN_GCC
+    if( PARM_DECL == TREE_CODE( decl ) &&
+        POINTER_TYPE == TREE_CODE( TREE_TYPE( decl ) ) )
+        return build1(
+            INDIRECT_REF, TREE_TYPE( TREE_TYPE( decl ) ), decl );
+#endif /* IN_GCC */
+
+    return decl;
+}
+
+#ifdef IN_GCC
+/**
+ * @brief Finds the variable an lvalue belongs to.
+ *
+ * @param[in] lval
+ *   The lvalue.
+ *
+ * @return
+ *   The declaration, or a constant.
+ */
+static tree
+astLvalBase(
+    tree lval
+    )
+{
+    tree base = lval;
+    while( ARRAY_REF == TREE_CODE( base ) ||
+           INDIRECT_REF == TREE_CODE( base ) )
+        base = TREE_OPERAND( base, 0 );
+
+    return base;
+}
+#endif /* IN_GCC */
+
+bool
+astWritable(
+    tree lval
+    )
+{
+#ifdef IN_GCC
+    tree base = astLvalBase( lval );
+
+    // Constants are substituted by their values.
+    if( INTEGER_CST == TREE_CODE( base ) )
+    {
+        fprintf( stderr, "Cannot modify a constant\n" );
+        return false;
+    }
+    if( DECL_LANG_FLAG_0( base ) )
+    {
+        fprintf( stderr, "Cannot modify control variable `%s'\n",
+                 IDENTIFIER_POINTER( DECL_NAME( base ) ) );
+        return false;
+    }
+    if( TREE_READONLY( base ) )
+    {
+        fprintf( stderr, "Cannot modify const argument `%s'\n",
+                 IDENTIFIER_POINTER( DECL_NAME( base ) ) );
+        return false;
+    }
+#endif /* IN_GCC */
+
+    return true;
+}
+
+void
+astLockControl(
+    tree var,
+    bool lock
+    )
+{
+#ifdef IN_GCC
+    DECL_LANG_FLAG_0( astLvalBase( var ) ) = lock;
+#endif /* IN_GCC */
+}
+
 /*************************************************************************/
 /* AstNode                                                               */
 /*************************************************************************/
+bool
+AstNode::bind()
+{
+    SymTable symTable;
+    return bind( symTable );
+}
+
 bool
 AstNode::translate() const
 {
     tree t;
-    SymTable symTable;
-    return translate( t, NULL_TREE, symTable );
+    return translate( t, NULL_TREE );
+}
+
+AstNode*
+AstNode::foldConst(
+    AstFold&
+    )
+{
+    return this;
 }
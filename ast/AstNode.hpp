@@ -9,17 +9,22 @@
 #define SFE__AST__AST_NODE_HPP__INCL__
 
 #include <cstdio>
+#include <stdint.h>
+
+#include "ast/AstArena.hpp"
 
 #ifdef IN_GCC
 #   include "config.h"
 #   include "system.h"
 #   include "coretypes.h"
+#   include "options.h"
 #   include "tree.h"
 #   include "tree-iterator.h"
 #   include "stringpool.h"
 #   include "print-tree.h"
 #else /* !IN_GCC */
 typedef void* tree;
+typedef unsigned int location_t;
 
 #   define NULL_TREE 0
 #   define UNKNOWN_LOCATION 0
@@ -27,6 +32,7 @@ typedef void* tree;
 #   define VAR_DECL 0
 #   define RESULT_DECL 0
 #   define PARM_DECL 0
+#   define INTEGER_CST 0
 
 #   define ARRAY_REF 0
 #   define DECL_EXPR 0
@@ -52,7 +58,9 @@ typedef void* tree;
 #   define TREE_CHAIN( a ) a
 #   define TREE_CODE( a ) a
 #   define TREE_OPERAND( a, b ) a
+#   define TREE_OVERFLOW( a ) (bool&)a
 #   define TREE_PUBLIC( a ) (bool&)a
+#   define TREE_READONLY( a ) (bool&)a
 #   define TREE_SIDE_EFFECTS( a ) (bool&)a
 #   define TREE_STATIC( a ) (bool&)a
 #   define TREE_TYPE( a ) a
@@ -69,6 +77,7 @@ typedef void* tree;
 #   define DECL_INITIAL( a ) a
 #   define DECL_RESULT( a ) a
 #   define DECL_SAVED_TREE( a ) a
+#   define DECL_SOURCE_LOCATION( a ) (location_t&)a
 #   define SET_EXPR_LOCATION( a, b )
 #   define TYPE_STRING_FLAG( a ) (bool&)a
 
@@ -80,10 +89,16 @@ typedef void* tree;
 #   define tree_cons( a, b, c ) NULL_TREE
 #   define alloc_stmt_list() NULL_TREE
 #   define append_to_statement_list( a, b ) NULL_TREE
+#   define fold( a ) NULL_TREE
+#   define fold_convert( a, b ) NULL_TREE
 #   define build1( a, b, c ) NULL_TREE
 #   define build2( a, b, c, d ) NULL_TREE
 #   define build3( a, b, c, d, e ) NULL_TREE
 #   define build4( a, b, c, d, e, f ) NULL_TREE
+#   define build1_loc( a, b, c, d ) NULL_TREE
+#   define build2_loc( a, b, c, d, e ) NULL_TREE
+#   define build3_loc( a, b, c, d, e, f ) NULL_TREE
+#   define build4_loc( a, b, c, d, e, f, g ) NULL_TREE
 #   define build_decl( a, b, c, d ) NULL_TREE
 #   define build_block( a, b, c, d ) NULL_TREE
 #   define build_string( a, b ) NULL_TREE
@@ -93,12 +108,128 @@ typedef void* tree;
 #   define build_array_type( a, b ) NULL_TREE
 #   define build_function_type( a, b ) NULL_TREE
 #   define build_call_expr_loc_array( a, b, c, d ) NULL_TREE
+#   define build_fold_addr_expr_loc( a, b ) NULL_TREE
 #   define debug_tree( a )
-#   define XNEWVEC( a, b ) NULL_TREE
+#   define XNEWVEC( a, b ) new a[b]
 #endif /* !IN_GCC */
 
+class AstFlat;
+class AstFold;
 class SymTable;
 
+/**
+ * @brief Obtains a source location.
+ *
+ * The line map grows whenever a line is asked for
+ * after a later one, so the locations should be
+ * obtained in the order of the source.
+ *
+ * @param[in] line
+ *   Line of the location.
+ * @param[in] col
+ *   Column of the location.
+ *
+ * @return
+ *   The location, or UNKNOWN_LOCATION outside GCC.
+ */
+location_t astLocation(
+    unsigned int line,
+    unsigned int col
+    );
+/**
+ * @brief Converts an expression to a truth value.
+ *
+ * A comparison wrapped by astIntValue is unwrapped,
+ * anything else is compared to zero.
+ *
+ * @param[in] loc
+ *   Location of the conversion.
+ * @param[in] t
+ *   The integer expression.
+ *
+ * @return
+ *   The expression of boolean type.
+ */
+tree astTruthValue(
+    location_t loc,
+    tree t
+    );
+/**
+ * @brief Converts a truth value to an integer.
+ *
+ * @param[in] t
+ *   The expression of boolean type.
+ *
+ * @return
+ *   The expression of integer type.
+ */
+tree astIntValue(
+    tree t
+    );
+/**
+ * @brief Refers to a variable or an argument.
+ *
+ * Arguments passed by reference are dereferenced.
+ *
+ * @param[in] decl
+ *   Declaration of the variable or argument.
+ *
+ * @return
+ *   The lvalue of the variable.
+ */
+tree astDeref(
+    tree decl
+    );
+/**
+ * @brief Checks that an lvalue may be modified.
+ *
+ * Complains about constants, locked control
+ * variables and arguments passed as const.
+ *
+ * @param[in] lval
+ *   The lvalue.
+ *
+ * @retval true
+ *   The lvalue may be modified.
+ * @retval false
+ *   The lvalue is read-only.
+ */
+bool astWritable(
+    tree lval
+    );
+/**
+ * @brief Locks or unlocks a control variable.
+ *
+ * A for loop counts its iterations on entry, so its
+ * body may not modify the control variable.
+ *
+ * @param[in] var
+ *   The control variable.
+ * @param[in] lock
+ *   Whether to lock or unlock the variable.
+ */
+void astLockControl(
+    tree var,
+    bool lock
+    );
+
+/**
+ * @brief A declaration slot.
+ *
+ * The binding pass points every reference to the slot
+ * of its declaration; translation of the declaration
+ * then fills in the tree.
+ *
+ * @author Jan Bobek
+ */
+struct AstSym
+{
+    /// Declaration of the symbol.
+    tree decl;
+    /// Array index offset.
+    int off;
+};
+
 /**
  * @brief A generic AST node.
  *
@@ -108,9 +239,41 @@ class AstNode
 {
 public:
     /**
-     * @brief Virtual destructor for proper destruction.
+     * @brief Allocates a node from an arena.
+     *
+     * @param[in] size
+     *   Size of the node.
+     * @param[in] arena
+     *   The arena to allocate from.
+     *
+     * @return
+     *   Memory for the node.
+     */
+    static void* operator new(
+        size_t size,
+        AstArena& arena
+        );
+    /**
+     * @brief Counterpart of the arena operator new,
+     *   used only if a constructor throws.
+     *
+     * @param[in] ptr
+     *   Memory of the node.
+     * @param[in] arena
+     *   The arena it was allocated from.
+     */
+    static void operator delete(
+        void* ptr,
+        AstArena& arena
+        );
+
+    /**
+     * @brief Sets the source location of the node.
+     *
+     * @param[in] loc
+     *   The location.
      */
-    virtual ~AstNode() {}
+    void setLoc( location_t loc );
 
     /**
      * @brief Prints the node to a file.
@@ -125,10 +288,34 @@ public:
         FILE* fp
         ) const = 0;
 
+    /**
+     * @brief Resolves all names in the AST.
+     *
+     * Must be done once before the AST is translated.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind();
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    virtual bool bind( SymTable& symTable ) = 0;
+
     /**
      * @brief Translates the AST into equivalent GENERIC tree.
      *
-     * The results are automatically registered using functions
+     * The AST must have been bound. The results are automatically registered using functions
      * <code>register_global_variable_declaration</code> and
      * <code>register_global_function_declaration</code> as
      * found in <code>sfe-lang.h</code>.
@@ -146,8 +333,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -156,9 +341,86 @@ public:
      */
     virtual bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const = 0;
+
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * Children are appended before their parent.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    virtual uint32_t flatten( AstFlat& flat ) const = 0;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * Must be done before the AST is bound or
+     * flattened; nodes without expressions are
+     * kept as they are.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node to use instead.
+     */
+    virtual AstNode* foldConst( AstFold& fold );
+
+protected:
+    /**
+     * @brief Initializes a node of unknown location.
+     */
+    AstNode();
+    /**
+     * @brief Nodes are released only with their arena.
+     */
+    ~AstNode() {}
+
+    /// Source location of the node.
+    location_t mLoc;
+
+private:
+    /**
+     * @brief Nodes cannot be deleted; declared only.
+     */
+    static void operator delete( void* ptr );
 };
 
+inline void*
+AstNode::operator new(
+    size_t size,
+    AstArena& arena
+    )
+{
+    return arena.alloc( size );
+}
+
+inline void
+AstNode::operator delete(
+    void*,
+    AstArena&
+    )
+{
+}
+
+inline
+AstNode::AstNode()
+: mLoc( UNKNOWN_LOCATION )
+{
+}
+
+inline void
+AstNode::setLoc(
+    location_t loc
+    )
+{
+    mLoc = loc;
+}
+
 #endif /* !SFE__AST__AST_NODE_HPP__INCL__ */
@@ -6,7 +6,10 @@
  */
 
 #include "ast/AstDeclNode.hpp"
+#include "ast/AstFlat.hpp"
+#include "ast/AstFold.hpp"
 #include "ast/AstExprNode.hpp"
+#include "ast/AstLib.hpp"
 #include "ast/AstStmtNode.hpp"
 #include "parser/SymTable.hpp"
 
@@ -24,12 +27,6 @@ AstBinopStmtNode::AstBinopStmtNode(
 {
 }
 
-AstBinopStmtNode::~AstBinopStmtNode()
-{
-    delete mLval;
-    delete mRval;
-}
-
 void
 AstBinopStmtNode::print(
     unsigned int off,
@@ -49,29 +46,60 @@ AstBinopStmtNode::print(
     mRval->print( off + 1, fp );
 }
 
+bool
+AstBinopStmtNode::bind(
+    SymTable& symTable
+    )
+{
+    return mLval->bind( symTable ) &&
+        mRval->bind( symTable );
+}
+
 bool
 AstBinopStmtNode::translate(
     tree& t,
-    tree ctx,
-    SymTable& symTable
+    tree ctx
     ) const
 {
     tree lval, rval;
-    if( !mLval->translate( lval, ctx, symTable ) ||
-        !mRval->translate( rval, ctx, symTable ) )
+    if( !mLval->translate( lval, ctx ) ||
+        !mRval->translate( rval, ctx ) ||
+        !astWritable( lval ) )
         return false;
 
     switch( mToken )
     {
-    case LEXTOK_ASSGN: t = build2( MODIFY_EXPR, TREE_TYPE( lval ), lval, rval ); return true;
+    case LEXTOK_ASSGN: t = build2_loc( mLoc, MODIFY_EXPR, TREE_TYPE( lval ), lval, rval ); return true;
 
-    case LEXTOK_KW_INC: t = build2( PREINCREMENT_EXPR, TREE_TYPE( lval ), lval, rval ); return true;
-    case LEXTOK_KW_DEC: t = build2( PREDECREMENT_EXPR, TREE_TYPE( lval ), lval, rval ); return true;
+    case LEXTOK_KW_INC: t = build2_loc( mLoc, PREINCREMENT_EXPR, TREE_TYPE( lval ), lval, rval ); return true;
+    case LEXTOK_KW_DEC: t = build2_loc( mLoc, PREDECREMENT_EXPR, TREE_TYPE( lval ), lval, rval ); return true;
 
     default: return false;
     }
 }
 
+uint32_t
+AstBinopStmtNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    uint32_t lval = mLval->flatten( flat );
+    uint32_t rval = mRval->flatten( flat );
+
+    return flat.addNode(
+        ASTFLAT_BINOP_STMT, mLoc, mToken, lval, rval );
+}
+
+AstNode*
+AstBinopStmtNode::foldConst(
+    AstFold& fold
+    )
+{
+    mLval = mLval->foldConst( fold );
+    mRval = mRval->foldConst( fold );
+    return this;
+}
+
 /*************************************************************************/
 /* AstFunStmtNode                                                        */
 /*************************************************************************/
@@ -82,11 +110,6 @@ AstFunStmtNode::AstFunStmtNode(
 {
 }
 
-AstFunStmtNode::~AstFunStmtNode()
-{
-    delete mFun;
-}
-
 void
 AstFunStmtNode::print(
     unsigned int off,
@@ -96,39 +119,51 @@ AstFunStmtNode::print(
     mFun->print( off, fp );
 }
 
+bool
+AstFunStmtNode::bind(
+    SymTable& symTable
+    )
+{
+    return mFun->bind( symTable );
+}
+
 bool
 AstFunStmtNode::translate(
     tree& t,
-    tree ctx,
-    SymTable& symTable
+    tree ctx
     ) const
 {
     return mFun->translate(
-        t, ctx, symTable );
+        t, ctx );
 }
 
-/*************************************************************************/
-/* AstBlkStmtNode                                                        */
-/*************************************************************************/
-AstBlkStmtNode::AstBlkStmtNode()
+uint32_t
+AstFunStmtNode::flatten(
+    AstFlat& flat
+    ) const
 {
+    // The call translates the same as a statement.
+    return mFun->flatten( flat );
 }
 
-AstBlkStmtNode::~AstBlkStmtNode()
+AstNode*
+AstFunStmtNode::foldConst(
+    AstFold& fold
+    )
 {
-    std::vector< AstLocDeclNode* >::iterator curd, endd;
-    curd = mDecls.begin();
-    endd = mDecls.end();
-    for(; curd != endd; ++curd )
-        delete *curd;
-    mDecls.clear();
+    mFun->foldConst( fold );
+    return this;
+}
 
-    std::vector< AstStmtNode* >::iterator curs, ends;
-    curs = mStmts.begin();
-    ends = mStmts.end();
-    for(; curs != ends; ++curs )
-        delete *curs;
-    mStmts.clear();
+/*************************************************************************/
+/* AstBlkStmtNode                                                        */
+/*************************************************************************/
+AstBlkStmtNode::AstBlkStmtNode(
+    AstArena& arena
+    )
+: mDecls( arena ),
+  mStmts( arena )
+{
 }
 
 void
@@ -139,6 +174,20 @@ AstBlkStmtNode::addDecl(
     mDecls.push_back( decl );
 }
 
+void
+AstBlkStmtNode::moveDecls(
+    AstProgDeclNode* prog
+    )
+{
+    AstList< AstLocDeclNode* >::const_iterator curd, endd;
+    curd = mDecls.begin();
+    endd = mDecls.end();
+    for(; curd != endd; ++curd )
+        prog->addGlobal( *curd );
+
+    mDecls.clear();
+}
+
 void
 AstBlkStmtNode::addStmt(
     AstStmtNode* stmt
@@ -153,7 +202,7 @@ AstBlkStmtNode::print(
     FILE* fp
     ) const
 {
-    std::vector< AstLocDeclNode* >::const_iterator curd, endd;
+    AstList< AstLocDeclNode* >::const_iterator curd, endd;
     curd = mDecls.begin();
     endd = mDecls.end();
     for(; curd != endd; ++curd )
@@ -161,7 +210,7 @@ AstBlkStmtNode::print(
 
     fprintf( fp, "%*cbegin\n", off, ' ' );
 
-    std::vector< AstStmtNode* >::const_iterator curs, ends;
+    AstList< AstStmtNode* >::const_iterator curs, ends;
     curs = mStmts.begin();
     ends = mStmts.end();
     for(; curs != ends; ++curs )
@@ -175,29 +224,56 @@ AstBlkStmtNode::print(
     fprintf( fp, "%*cend\n", off, ' ' );
 }
 
+bool
+AstBlkStmtNode::bind(
+    SymTable& symTable
+    )
+{
+    SymScope scope( symTable );
+
+    AstList< AstLocDeclNode* >::iterator curd, endd;
+    curd = mDecls.begin();
+    endd = mDecls.end();
+    for(; curd != endd; ++curd )
+        if( !(*curd)->bind( symTable ) )
+            return false;
+
+    AstList< AstStmtNode* >::iterator curs, ends;
+    curs = mStmts.begin();
+    ends = mStmts.end();
+    for(; curs != ends; ++curs )
+        if( !(*curs)->bind( symTable ) )
+            return false;
+
+    return true;
+}
+
 bool
 AstBlkStmtNode::translate(
     tree& t,
-    tree ctx,
-    SymTable& symTable
+    tree ctx
     ) const
 {
     tree decls = NULL_TREE;
     tree stmts = alloc_stmt_list();
-    SymTable subTable( symTable );
 
-    std::vector< AstLocDeclNode* >::const_iterator curd, endd;
+    AstList< AstLocDeclNode* >::const_iterator curd, endd;
     curd = mDecls.begin();
     endd = mDecls.end();
     for(; curd != endd; ++curd )
     {
         tree decl;
-        if( !(*curd)->translate( decl, ctx, subTable ) )
+        if( !(*curd)->translate( decl, ctx ) )
             return false;
 
+        // Constants are substituted at their uses.
+        if( INTEGER_CST == TREE_CODE( decl ) )
+            continue;
+
         decls = chainon( decls, decl );
         append_to_statement_list(
-            build1( DECL_EXPR, void_type_node, decl ),
+            build1_loc( DECL_SOURCE_LOCATION( decl ),
+                        DECL_EXPR, void_type_node, decl ),
             &stmts );
     }
 
@@ -205,20 +281,20 @@ AstBlkStmtNode::translate(
         decls, NULL_TREE, NULL_TREE, NULL_TREE );
     TREE_USED( block ) = true;
 
-    std::vector< AstStmtNode* >::const_iterator curs, ends;
+    AstList< AstStmtNode* >::const_iterator curs, ends;
     curs = mStmts.begin();
     ends = mStmts.end();
     for(; curs != ends; ++curs )
     {
         tree stmt;
-        if( !(*curs)->translate( stmt, block, subTable ) )
+        if( !(*curs)->translate( stmt, block ) )
             return false;
 
         append_to_statement_list( stmt, &stmts );
     }
 
-    t = build3(
-        BIND_EXPR, void_type_node,
+    t = build3_loc(
+        mLoc, BIND_EXPR, void_type_node,
         BLOCK_VARS( block ), stmts, block );
     TREE_SIDE_EFFECTS( t ) = true;
 
@@ -234,6 +310,51 @@ AstBlkStmtNode::translate(
     return true;
 }
 
+uint32_t
+AstBlkStmtNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    std::vector< uint32_t > items;
+
+    AstList< AstLocDeclNode* >::const_iterator curd, endd;
+    curd = mDecls.begin();
+    endd = mDecls.end();
+    for(; curd != endd; ++curd )
+        items.push_back( (*curd)->flatten( flat ) );
+
+    AstList< AstStmtNode* >::const_iterator curs, ends;
+    curs = mStmts.begin();
+    ends = mStmts.end();
+    for(; curs != ends; ++curs )
+        items.push_back( (*curs)->flatten( flat ) );
+
+    return flat.addNode(
+        ASTFLAT_BLK_STMT, mLoc, LEXTOK_EOI,
+        flat.addList( items ), mDecls.size(),
+        mStmts.size() );
+}
+
+AstNode*
+AstBlkStmtNode::foldConst(
+    AstFold& fold
+    )
+{
+    AstList< AstLocDeclNode* >::iterator curd, endd;
+    curd = mDecls.begin();
+    endd = mDecls.end();
+    for(; curd != endd; ++curd )
+        (*curd)->foldConst( fold );
+
+    AstList< AstStmtNode* >::iterator curs, ends;
+    curs = mStmts.begin();
+    ends = mStmts.end();
+    for(; curs != ends; ++curs )
+        (*curs)->foldConst( fold );
+
+    return this;
+}
+
 /*************************************************************************/
 /* AstIfStmtNode                                                         */
 /*************************************************************************/
@@ -248,13 +369,6 @@ AstIfStmtNode::AstIfStmtNode(
 {
 }
 
-AstIfStmtNode::~AstIfStmtNode()
-{
-    delete mCond;
-    delete mThenBlk;
-    delete mElseBlk;
-}
-
 void
 AstIfStmtNode::print(
     unsigned int off,
@@ -274,30 +388,69 @@ AstIfStmtNode::print(
     }
 }
 
+bool
+AstIfStmtNode::bind(
+    SymTable& symTable
+    )
+{
+    return mCond->bind( symTable ) &&
+        mThenBlk->bind( symTable ) &&
+        (NULL == mElseBlk ||
+         mElseBlk->bind( symTable ));
+}
+
 bool
 AstIfStmtNode::translate(
     tree& t,
-    tree ctx,
-    SymTable& symTable
+    tree ctx
     ) const
 {
     tree cond, thenBlk, elseBlk;
-    if( !mCond->translate( cond, ctx, symTable ) ||
-        !mThenBlk->translate( thenBlk, ctx, symTable ) )
+    if( !mCond->translate( cond, ctx ) ||
+        !mThenBlk->translate( thenBlk, ctx ) )
         return false;
 
     if( NULL == mElseBlk )
         elseBlk = NULL_TREE;
-    else if( !mElseBlk->translate( elseBlk, ctx, symTable ) )
+    else if( !mElseBlk->translate( elseBlk, ctx ) )
         return false;
 
-    t = build3(
-        COND_EXPR, void_type_node,
-        cond, thenBlk, elseBlk );
+    t = build3_loc(
+        mLoc, COND_EXPR, void_type_node,
+        astTruthValue( mLoc, cond ), thenBlk, elseBlk );
 
     return true;
 }
 
+uint32_t
+AstIfStmtNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    uint32_t cond = mCond->flatten( flat );
+    uint32_t thenBlk = mThenBlk->flatten( flat );
+    uint32_t elseBlk = (NULL == mElseBlk ? ASTFLAT_NONE
+                        : mElseBlk->flatten( flat ));
+
+    return flat.addNode(
+        ASTFLAT_IF_STMT, mLoc, LEXTOK_EOI,
+        cond, thenBlk, elseBlk );
+}
+
+AstNode*
+AstIfStmtNode::foldConst(
+    AstFold& fold
+    )
+{
+    mCond = mCond->foldConst( fold );
+    mThenBlk->foldConst( fold );
+
+    if( NULL != mElseBlk )
+        mElseBlk->foldConst( fold );
+
+    return this;
+}
+
 /*************************************************************************/
 /* AstLoopStmtNode                                                       */
 /*************************************************************************/
@@ -308,11 +461,6 @@ AstLoopStmtNode::AstLoopStmtNode(
 {
 }
 
-AstLoopStmtNode::~AstLoopStmtNode()
-{
-    delete mBody;
-}
-
 void
 AstLoopStmtNode::print(
     unsigned int off,
@@ -327,21 +475,243 @@ AstLoopStmtNode::print(
     mBody->print( off + 1, fp );
 }
 
+bool
+AstLoopStmtNode::bind(
+    SymTable& symTable
+    )
+{
+    return mBody->bind( symTable );
+}
+
 bool
 AstLoopStmtNode::translate(
     tree& t,
-    tree ctx,
-    SymTable& symTable
+    tree ctx
     ) const
 {
     tree body;
-    if( !mBody->translate( body, ctx, symTable ) )
+    if( !mBody->translate( body, ctx ) )
+        return false;
+
+    t = build1_loc( mLoc, LOOP_EXPR, void_type_node, body );
+    return true;
+}
+
+uint32_t
+AstLoopStmtNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    uint32_t body = mBody->flatten( flat );
+
+    return flat.addNode(
+        ASTFLAT_LOOP_STMT, mLoc, LEXTOK_EOI, body );
+}
+
+AstNode*
+AstLoopStmtNode::foldConst(
+    AstFold& fold
+    )
+{
+    mBody->foldConst( fold );
+    return this;
+}
+
+/*************************************************************************/
+/* AstForStmtNode                                                        */
+/*************************************************************************/
+AstForStmtNode::AstForStmtNode(
+    LexToken tok,
+    AstExprNode* var,
+    AstExprNode* from,
+    AstExprNode* to,
+    AstBlkStmtNode* body
+    )
+: mToken( tok ),
+  mVar( var ),
+  mFrom( from ),
+  mTo( to ),
+  mBody( body )
+{
+}
+
+void
+AstForStmtNode::print(
+    unsigned int off,
+    FILE* fp
+    ) const
+{
+    fprintf(
+        fp,
+        "%*cfor\n",
+        off, ' ' );
+
+    mVar->print( off + 1, fp );
+    fprintf( fp, "%*c:=\n", off, ' ' );
+    mFrom->print( off + 1, fp );
+
+    switch( mToken )
+    {
+    case LEXTOK_KW_TO:    fprintf( fp, "%*cto\n", off, ' ' ); break;
+    case LEXTOK_KW_DWNTO: fprintf( fp, "%*cdownto\n", off, ' ' ); break;
+    }
+
+    mTo->print( off + 1, fp );
+    mBody->print( off + 1, fp );
+}
+
+bool
+AstForStmtNode::bind(
+    SymTable& symTable
+    )
+{
+    return mVar->bind( symTable ) &&
+        mFrom->bind( symTable ) &&
+        mTo->bind( symTable ) &&
+        mBody->bind( symTable );
+}
+
+bool
+AstForStmtNode::translate(
+    tree& t,
+    tree ctx
+    ) const
+{
+    tree var, from, to, body;
+    if( !mVar->translate( var, ctx ) ||
+        !astWritable( var ) ||
+        !mFrom->translate( from, ctx ) ||
+        !mTo->translate( to, ctx ) )
+        return false;
+
+    astLockControl( var, true );
+    bool translated = mBody->translate( body, ctx );
+    astLockControl( var, false );
+
+    if( !translated )
         return false;
 
-    t = build1( LOOP_EXPR, void_type_node, body );
+    t = buildLoop( mLoc, mToken, var, from, to, body );
     return true;
 }
 
+uint32_t
+AstForStmtNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    std::vector< uint32_t > items;
+    uint32_t var = mVar->flatten( flat );
+    items.push_back( mFrom->flatten( flat ) );
+    items.push_back( mTo->flatten( flat ) );
+    items.push_back( mBody->flatten( flat ) );
+
+    return flat.addNode(
+        ASTFLAT_FOR_STMT, mLoc, mToken,
+        var, flat.addList( items ) );
+}
+
+AstNode*
+AstForStmtNode::foldConst(
+    AstFold& fold
+    )
+{
+    mFrom = mFrom->foldConst( fold );
+    mTo = mTo->foldConst( fold );
+    mBody->foldConst( fold );
+
+    return this;
+}
+
+tree
+AstForStmtNode::buildLoop(
+    location_t loc,
+    LexToken tok,
+    tree var,
+    tree from,
+    tree to,
+    tree body
+    )
+{
+    const bool inc = (LEXTOK_KW_TO == tok);
+
+    // The final value is evaluated once, before the
+    // control variable is assigned.
+    tree stop = build_decl(
+        loc, VAR_DECL, NULL_TREE, TREE_TYPE( var ) );
+    DECL_ARTIFICIAL( stop ) = true;
+
+    // Like the DO loops of gfortran, the loop counts down
+    // the remaining iterations in an unsigned variable, so
+    // the number of iterations is known on entry.
+    tree count = build_decl(
+        loc, VAR_DECL, NULL_TREE, unsigned_type_node );
+    DECL_ARTIFICIAL( count ) = true;
+
+    tree first = fold_convert( unsigned_type_node, var );
+    tree last = fold_convert( unsigned_type_node, stop );
+
+    // The counter is tested before the variable is
+    // stepped, so the variable never passes the final
+    // value.
+    tree stmts = alloc_stmt_list();
+    append_to_statement_list( body, &stmts );
+    append_to_statement_list(
+        build1_loc(
+            loc, EXIT_EXPR, void_type_node,
+            build2_loc(
+                loc, EQ_EXPR, boolean_type_node,
+                build2_loc(
+                    loc, POSTDECREMENT_EXPR, unsigned_type_node, count,
+                    build_int_cst( unsigned_type_node, 1 ) ),
+                build_int_cst( unsigned_type_node, 0 ) ) ),
+        &stmts );
+    append_to_statement_list(
+        build2_loc(
+            loc, (inc ? PREINCREMENT_EXPR : PREDECREMENT_EXPR),
+            TREE_TYPE( var ), var,
+            build_int_cst( TREE_TYPE( var ), 1 ) ),
+        &stmts );
+
+    tree enter = alloc_stmt_list();
+    append_to_statement_list(
+        build2_loc(
+            loc, MODIFY_EXPR, unsigned_type_node, count,
+            build2_loc(
+                loc, MINUS_EXPR, unsigned_type_node,
+                (inc ? last : first), (inc ? first : last) ) ),
+        &enter );
+    append_to_statement_list(
+        build1_loc( loc, LOOP_EXPR, void_type_node, stmts ),
+        &enter );
+
+    tree t = alloc_stmt_list();
+    append_to_statement_list(
+        build2_loc(
+            loc, MODIFY_EXPR, TREE_TYPE( stop ), stop, to ),
+        &t );
+    append_to_statement_list(
+        build2_loc(
+            loc, MODIFY_EXPR, TREE_TYPE( var ), var, from ),
+        &t );
+    append_to_statement_list(
+        build3_loc(
+            loc, COND_EXPR, void_type_node,
+            build2_loc(
+                loc, (inc ? LE_EXPR : GE_EXPR),
+                boolean_type_node, var, stop ),
+            enter, NULL_TREE ),
+        &t );
+
+    // The temporaries need no block of their own.
+    t = build3_loc(
+        loc, BIND_EXPR, void_type_node,
+        chainon( stop, count ), t, NULL_TREE );
+    TREE_SIDE_EFFECTS( t ) = true;
+
+    return t;
+}
+
 /*************************************************************************/
 /* AstBreakStmtNode                                                      */
 /*************************************************************************/
@@ -352,11 +722,6 @@ AstBreakStmtNode::AstBreakStmtNode(
 {
 }
 
-AstBreakStmtNode::~AstBreakStmtNode()
-{
-    delete mCond;
-}
-
 void
 AstBreakStmtNode::print(
     unsigned int off,
@@ -371,24 +736,58 @@ AstBreakStmtNode::print(
     mCond->print( off + 1, fp );
 }
 
+bool
+AstBreakStmtNode::bind(
+    SymTable& symTable
+    )
+{
+    return mCond->bind( symTable );
+}
+
 bool
 AstBreakStmtNode::translate(
     tree& t,
-    tree ctx,
-    SymTable& symTable
+    tree ctx
     ) const
 {
     tree cond;
-    if( !mCond->translate( cond, ctx, symTable ) )
+    if( !mCond->translate( cond, ctx ) )
         return false;
 
-    t = build1( EXIT_EXPR, void_type_node, cond );
+    t = build1_loc(
+        mLoc, EXIT_EXPR, void_type_node,
+        astTruthValue( mLoc, cond ) );
     return true;
 }
 
+uint32_t
+AstBreakStmtNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    uint32_t cond = mCond->flatten( flat );
+
+    return flat.addNode(
+        ASTFLAT_BREAK_STMT, mLoc, LEXTOK_EOI, cond );
+}
+
+AstNode*
+AstBreakStmtNode::foldConst(
+    AstFold& fold
+    )
+{
+    mCond = mCond->foldConst( fold );
+    return this;
+}
+
 /*************************************************************************/
 /* AstExitStmtNode                                                       */
 /*************************************************************************/
+AstExitStmtNode::AstExitStmtNode()
+: mRes( NULL )
+{
+}
+
 void
 AstExitStmtNode::print(
     unsigned int off,
@@ -398,20 +797,36 @@ AstExitStmtNode::print(
     fprintf( fp, "%*cexit\n", off, ' ' );
 }
 
+bool
+AstExitStmtNode::bind(
+    SymTable& symTable
+    )
+{
+    mRes = symTable.getRes();
+    return true;
+}
+
 bool
 AstExitStmtNode::translate(
     tree& t,
-    tree,
-    SymTable& symTable
+    tree
     ) const
 {
-    t = build1(
-        RETURN_EXPR,
+    t = build1_loc(
+        mLoc, RETURN_EXPR,
         void_type_node,
-        symTable.getRes() );
+        (NULL == mRes ? NULL_TREE : mRes->decl) );
     return true;
 }
 
+uint32_t
+AstExitStmtNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    return flat.addNode( ASTFLAT_EXIT_STMT, mLoc );
+}
+
 /*************************************************************************/
 /* AstReadStmtNode                                                       */
 /*************************************************************************/
@@ -419,17 +834,11 @@ AstReadStmtNode::AstReadStmtNode(
     const char* fmt,
     AstExprNode* expr
     )
-: mFmt( new AstStrExprNode( fmt ) ),
+: mFmt( fmt ),
   mExpr( expr )
 {
 }
 
-AstReadStmtNode::~AstReadStmtNode()
-{
-    delete mFmt;
-    delete mExpr;
-}
-
 void
 AstReadStmtNode::print(
     unsigned int off,
@@ -441,7 +850,7 @@ AstReadStmtNode::print(
         "%*cscanf(\n",
         off, ' ' );
 
-    mFmt->print( off + 1, fp );
+    mFmt.print( off + 1, fp );
 
     fprintf(
         fp,
@@ -456,60 +865,62 @@ AstReadStmtNode::print(
         off, ' ' );
 }
 
+bool
+AstReadStmtNode::bind(
+    SymTable& symTable
+    )
+{
+    return mFmt.bind( symTable ) &&
+        mExpr->bind( symTable );
+}
+
 bool
 AstReadStmtNode::translate(
     tree& t,
-    tree ctx,
-    SymTable& symTable
+    tree ctx
     ) const
 {
     tree fmt, expr;
-    if( !mFmt->translate( fmt, ctx, symTable ) ||
-        !mExpr->translate( expr, ctx, symTable ) )
+    if( !mFmt.translate( fmt, ctx ) ||
+        !mExpr->translate( expr, ctx ) ||
+        !astWritable( expr ) )
         return false;
 
-    expr = build1(
-        ADDR_EXPR, build_pointer_type(
-            TREE_TYPE( expr ) ),
-        expr );
-
-    tree params = NULL_TREE;
-    chainon( params, tree_cons(
-                 NULL_TREE,
-                 TREE_TYPE( fmt ),
-                 NULL_TREE ) );
-    chainon( params, tree_cons(
-                 NULL_TREE,
-                 TREE_TYPE( expr ),
-                 NULL_TREE ) );
-
-    tree resdecl = build_decl(
-        BUILTINS_LOCATION, RESULT_DECL,
-        NULL_TREE, integer_type_node );
-    DECL_ARTIFICIAL( resdecl ) = true;
-    DECL_IGNORED_P( resdecl ) = true;
-
-    tree fntype = build_function_type(
-        TREE_TYPE( resdecl ), params );
-    tree fndecl = build_decl(
-        UNKNOWN_LOCATION, FUNCTION_DECL,
-        get_identifier( "scanf" ), fntype );
-    DECL_ARGUMENTS( fndecl ) = NULL_TREE;
-    DECL_RESULT( fndecl ) = resdecl;
-    DECL_EXTERNAL( fndecl ) = true;
-
-    tree* args = XNEWVEC( tree, 2 );
-    args[0] = fmt;
-    args[1] = expr;
+    expr = build_fold_addr_expr_loc( mLoc, expr );
+
+    tree args[2] = { fmt, expr };
 
     t = build_call_expr_loc_array(
-        UNKNOWN_LOCATION, fndecl, 2, args );
-    SET_EXPR_LOCATION( t, UNKNOWN_LOCATION );
+        mLoc,
+        AstLib::global().getFun( "scanf" ),
+        2, args );
+    SET_EXPR_LOCATION( t, mLoc );
     TREE_USED( t ) = true;
 
     return true;
 }
 
+uint32_t
+AstReadStmtNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    uint32_t fmt = mFmt.flatten( flat );
+    uint32_t expr = mExpr->flatten( flat );
+
+    return flat.addNode(
+        ASTFLAT_READ_STMT, mLoc, LEXTOK_EOI, fmt, expr );
+}
+
+AstNode*
+AstReadStmtNode::foldConst(
+    AstFold& fold
+    )
+{
+    mExpr = mExpr->foldConst( fold );
+    return this;
+}
+
 /*************************************************************************/
 /* AstWriteStmtNode                                                      */
 /*************************************************************************/
@@ -517,17 +928,11 @@ AstWriteStmtNode::AstWriteStmtNode(
     const char* fmt,
     AstExprNode* expr
     )
-: mFmt( new AstStrExprNode( fmt ) ),
+: mFmt( fmt ),
   mExpr( expr )
 {
 }
 
-AstWriteStmtNode::~AstWriteStmtNode()
-{
-    delete mFmt;
-    delete mExpr;
-}
-
 void
 AstWriteStmtNode::print(
     unsigned int off,
@@ -539,7 +944,7 @@ AstWriteStmtNode::print(
         "%*cprintf(\n",
         off, ' ' );
 
-    mFmt->print( off + 1, fp );
+    mFmt.print( off + 1, fp );
 
     fprintf(
         fp,
@@ -554,51 +959,55 @@ AstWriteStmtNode::print(
         off, ' ' );
 }
 
+bool
+AstWriteStmtNode::bind(
+    SymTable& symTable
+    )
+{
+    return mFmt.bind( symTable ) &&
+        mExpr->bind( symTable );
+}
+
 bool
 AstWriteStmtNode::translate(
     tree& t,
-    tree ctx,
-    SymTable& symTable
+    tree ctx
     ) const
 {
     tree fmt, expr;
-    if( !mFmt->translate( fmt, ctx, symTable ) ||
-        !mExpr->translate( expr, ctx, symTable ) )
+    if( !mFmt.translate( fmt, ctx ) ||
+        !mExpr->translate( expr, ctx ) )
         return false;
 
-    tree params = NULL_TREE;
-    chainon( params, tree_cons(
-                 NULL_TREE,
-                 TREE_TYPE( fmt ),
-                 NULL_TREE ) );
-    chainon( params, tree_cons(
-                 NULL_TREE,
-                 TREE_TYPE( expr ),
-                 NULL_TREE ) );
-
-    tree resdecl = build_decl(
-        BUILTINS_LOCATION, RESULT_DECL,
-        NULL_TREE, integer_type_node );
-    DECL_ARTIFICIAL( resdecl ) = true;
-    DECL_IGNORED_P( resdecl ) = true;
-
-    tree fntype = build_function_type(
-        TREE_TYPE( resdecl ), params );
-    tree fndecl = build_decl(
-        UNKNOWN_LOCATION, FUNCTION_DECL,
-        get_identifier( "printf" ), fntype );
-    DECL_ARGUMENTS( fndecl ) = NULL_TREE;
-    DECL_RESULT( fndecl ) = resdecl;
-    DECL_EXTERNAL( fndecl ) = true;
-
-    tree* args = XNEWVEC( tree, 2 );
-    args[0] = fmt;
-    args[1] = expr;
+    tree args[2] = { fmt, expr };
 
     t = build_call_expr_loc_array(
-        UNKNOWN_LOCATION, fndecl, 2, args );
-    SET_EXPR_LOCATION( t, UNKNOWN_LOCATION );
+        mLoc,
+        AstLib::global().getFun( "printf" ),
+        2, args );
+    SET_EXPR_LOCATION( t, mLoc );
     TREE_USED( t ) = true;
 
     return true;
 }
+
+uint32_t
+AstWriteStmtNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    uint32_t fmt = mFmt.flatten( flat );
+    uint32_t expr = mExpr->flatten( flat );
+
+    return flat.addNode(
+        ASTFLAT_WRITE_STMT, mLoc, LEXTOK_EOI, fmt, expr );
+}
+
+AstNode*
+AstWriteStmtNode::foldConst(
+    AstFold& fold
+    )
+{
+    mExpr = mExpr->foldConst( fold );
+    return this;
+}
@@ -8,14 +8,11 @@
 #ifndef SFE__AST__AST_STMT_NODE_HPP__INCL__
 #define SFE__AST__AST_STMT_NODE_HPP__INCL__
 
-#include <string>
-#include <vector>
-
+#include "ast/AstExprNode.hpp"
 #include "ast/AstNode.hpp"
 
-class AstExprNode;
-class AstFunExprNode;
 class AstLocDeclNode;
+class AstProgDeclNode;
 
 /**
  * @brief A generic statement node.
@@ -51,10 +48,6 @@ public:
         AstExprNode* lval,
         AstExprNode* rval
         );
-    /**
-     * @brief Frees L-value and R-value.
-     */
-    ~AstBinopStmtNode();
 
     /**
      * @brief Prints the node to a file.
@@ -68,6 +61,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -75,8 +80,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -85,9 +88,29 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node itself.
+     */
+    AstNode* foldConst( AstFold& fold );
 
 protected:
     /// Lex token of the binop.
@@ -114,10 +137,6 @@ public:
      *   The funcall expression to wrap.
      */
     AstFunStmtNode( AstFunExprNode* fun );
-    /**
-     * @brief Frees the wrapped funcall expression.
-     */
-    ~AstFunStmtNode();
 
     /**
      * @brief Prints the node to a file.
@@ -131,6 +150,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -138,8 +169,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -148,9 +177,29 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node itself.
+     */
+    AstNode* foldConst( AstFold& fold );
 
 protected:
     /// Wrapped funcall expression.
@@ -168,13 +217,11 @@ class AstBlkStmtNode
 public:
     /**
      * @brief Initializes the node.
+     *
+     * @param[in] arena
+     *   The arena to allocate the lists from.
      */
-    AstBlkStmtNode();
-    /**
-     * @brief Frees the contained declarations
-     *   and statements.
-     */
-    ~AstBlkStmtNode();
+    AstBlkStmtNode( AstArena& arena );
 
     /**
      * @brief Adds a local declaration to the block.
@@ -183,6 +230,13 @@ public:
      *   The declaration to append.
      */
     void addDecl( AstLocDeclNode* decl );
+    /**
+     * @brief Moves the declarations to a program.
+     *
+     * @param[in,out] prog
+     *   The program to make the declarations global in.
+     */
+    void moveDecls( AstProgDeclNode* prog );
     /**
      * @brief Adds a statement to the block.
      *
@@ -203,6 +257,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates ito appropriate tree.
      *
@@ -210,8 +276,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -220,15 +284,35 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node itself.
+     */
+    AstNode* foldConst( AstFold& fold );
 
 protected:
     /// The declarations within.
-    std::vector< AstLocDeclNode* > mDecls;
+    AstList< AstLocDeclNode* > mDecls;
     /// The statements within.
-    std::vector< AstStmtNode* > mStmts;
+    AstList< AstStmtNode* > mStmts;
 };
 
 /**
@@ -255,10 +339,6 @@ public:
         AstBlkStmtNode* thenBlk,
         AstBlkStmtNode* elseBlk
         );
-    /**
-     * @brief Frees the condition and blocks.
-     */
-    ~AstIfStmtNode();
 
     /**
      * @brief Prints the node to a file.
@@ -272,6 +352,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -279,8 +371,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -289,9 +379,29 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node itself.
+     */
+    AstNode* foldConst( AstFold& fold );
 
 protected:
     /// Conditional expression.
@@ -318,10 +428,6 @@ public:
      *   Body of the loop.
      */
     AstLoopStmtNode( AstBlkStmtNode* body );
-    /**
-     * @brief Frees the body.
-     */
-    ~AstLoopStmtNode();
 
     /**
      * @brief Prints the node to a file.
@@ -335,6 +441,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -342,21 +460,179 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
+     *
+     * @retval true
+     *   Translation successful.
+     * @retval false
+     *   Translation failed.
+     */
+    bool translate(
+        tree& t,
+        tree ctx
+        ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node itself.
+     */
+    AstNode* foldConst( AstFold& fold );
+
+protected:
+    /// The loop body.
+    AstBlkStmtNode* mBody;
+};
+
+/**
+ * @brief A counted loop statement node.
+ *
+ * @author Jan Bobek
+ */
+class AstForStmtNode
+: public AstStmtNode
+{
+public:
+    /**
+     * @brief Initializes the loop.
+     *
+     * @param[in] tok
+     *   LEXTOK_KW_TO or LEXTOK_KW_DWNTO.
+     * @param[in] var
+     *   The control variable.
+     * @param[in] from
+     *   The initial value.
+     * @param[in] to
+     *   The final value.
+     * @param[in] body
+     *   Body of the loop.
+     */
+    AstForStmtNode(
+        LexToken tok,
+        AstExprNode* var,
+        AstExprNode* from,
+        AstExprNode* to,
+        AstBlkStmtNode* body
+        );
+
+    /**
+     * @brief Prints the node to a file.
+     *
+     * @param[in] off
+     *   Line offset to use.
+     * @param[in] fp
+     *   File to print to.
+     */
+    void print(
+        unsigned int off,
+        FILE* fp
+        ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
      * @param[in,out] symTable
      *   A symbol table.
      *
      * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
+    /**
+     * @brief Translates into appropriate tree.
+     *
+     * @param[out] t
+     *   Where to store the translated tree.
+     * @param[in,out] ctx
+     *   Context in which the node appears.
+     *
+     * @retval true
      *   Translation successful.
      * @retval false
      *   Translation failed.
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node itself.
+     */
+    AstNode* foldConst( AstFold& fold );
+
+    /**
+     * @brief Builds the tree of a counted loop.
+     *
+     * The final value is evaluated once, before the
+     * control variable is assigned, and the variable is
+     * never stepped past it, so the loop cannot
+     * overflow at the ends of the integer range.
+     *
+     * @param[in] loc
+     *   Location of the loop.
+     * @param[in] tok
+     *   LEXTOK_KW_TO or LEXTOK_KW_DWNTO.
+     * @param[in] var
+     *   The translated control variable.
+     * @param[in] from
+     *   The translated initial value.
+     * @param[in] to
+     *   The translated final value.
+     * @param[in] body
+     *   The translated body.
+     *
+     * @return
+     *   The loop.
+     */
+    static tree buildLoop(
+        location_t loc,
+        LexToken tok,
+        tree var,
+        tree from,
+        tree to,
+        tree body
+        );
 
 protected:
+    /// LEXTOK_KW_TO or LEXTOK_KW_DWNTO.
+    LexToken mToken;
+    /// The control variable.
+    AstExprNode* mVar;
+    /// The initial value.
+    AstExprNode* mFrom;
+    /// The final value.
+    AstExprNode* mTo;
     /// The loop body.
     AstBlkStmtNode* mBody;
 };
@@ -377,10 +653,6 @@ public:
      *   The breaking condition.
      */
     AstBreakStmtNode( AstExprNode* cond );
-    /**
-     * @brief Frees the condition expr.
-     */
-    ~AstBreakStmtNode();
 
     /**
      * @brief Prints the node to a file.
@@ -394,6 +666,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -401,8 +685,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -411,9 +693,29 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node itself.
+     */
+    AstNode* foldConst( AstFold& fold );
 
 protected:
     /// The break condition.
@@ -429,6 +731,11 @@ class AstExitStmtNode
 : public AstStmtNode
 {
 public:
+    /**
+     * @brief Initializes the node.
+     */
+    AstExitStmtNode();
+
     /**
      * @brief Prints the node to a file.
      *
@@ -441,6 +748,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -448,8 +767,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -458,9 +775,22 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+protected:
+    /// Slot of the result, set by bind().
+    const AstSym* mRes;
 };
 
 /**
@@ -484,10 +814,6 @@ public:
         const char* fmt,
         AstExprNode* expr
         );
-    /**
-     * @brief Deletes the format and expr.
-     */
-    ~AstReadStmtNode();
 
     /**
      * @brief Prints the node to a file.
@@ -501,6 +827,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -508,8 +846,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -518,13 +854,33 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node itself.
+     */
+    AstNode* foldConst( AstFold& fold );
 
 protected:
     /// The format string.
-    AstStrExprNode* mFmt;
+    AstStrExprNode mFmt;
     /// The expression to print.
     AstExprNode* mExpr;
 };
@@ -550,10 +906,6 @@ public:
         const char* fmt,
         AstExprNode* expr
         );
-    /**
-     * @brief Deletes the format and expr.
-     */
-    ~AstWriteStmtNode();
 
     /**
      * @brief Prints the node to a file.
@@ -567,6 +919,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates into appropriate tree.
      *
@@ -574,8 +938,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -584,13 +946,33 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
+
+    /**
+     * @brief Folds constant operations in the node.
+     *
+     * @param[in,out] fold
+     *   The folding pass.
+     *
+     * @return
+     *   The node itself.
+     */
+    AstNode* foldConst( AstFold& fold );
 
 protected:
     /// The format string.
-    AstStrExprNode* mFmt;
+    AstStrExprNode mFmt;
     /// The expression to print.
     AstExprNode* mExpr;
 };
@@ -5,37 +5,23 @@
  * @since 5th June 2014
  */
 
+#include "sfe-lang.h"
+#include "ast/AstFlat.hpp"
 #include "ast/AstTypeNode.hpp"
 #include "parser/SymTable.hpp"
 
 /*************************************************************************/
 /* AstIntTypeNode                                                        */
 /*************************************************************************/
-AstTypeNode*
-AstIntTypeNode::clone() const
-{
-    return new AstIntTypeNode();
-}
-
-tree
-AstIntTypeNode::getSym(
-    const char* name,
-    SymTable& symTable
-    ) const
-{
-    return symTable.getVar(
-        name );
-}
-
 bool
 AstIntTypeNode::addSym(
-    const char* name,
-    tree decl,
+    const Ident* name,
+    AstSym* sym,
     SymTable& symTable
     ) const
 {
     return symTable.addVar(
-        name, decl );
+        name, sym );
 }
 
 void
@@ -47,17 +33,32 @@ AstIntTypeNode::print(
     fprintf( fp, "%*cinteger\n", off, ' ' );
 }
 
+bool
+AstIntTypeNode::bind(
+    SymTable&
+    )
+{
+    return true;
+}
+
 bool
 AstIntTypeNode::translate(
     tree& t,
-    tree,
-    SymTable&
+    tree
     ) const
 {
     t = integer_type_node;
     return true;
 }
 
+uint32_t
+AstIntTypeNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    return flat.addNode( ASTFLAT_INT_TYPE, mLoc );
+}
+
 /*************************************************************************/
 /* AstArrTypeNode                                                        */
 /*************************************************************************/
@@ -68,43 +69,21 @@ AstArrTypeNode::AstArrTypeNode(
     )
 : mBegin( begin ),
   mEnd( end ),
-  mElemType( elemType )
+  mElemType( elemType ),
+  mTree( NULL_TREE )
 {
 }
 
-AstArrTypeNode::~AstArrTypeNode()
-{
-    delete mElemType;
-}
-
-AstTypeNode*
-AstArrTypeNode::clone() const
-{
-    return new AstArrTypeNode(
-        mBegin, mEnd,
-        mElemType->clone() );
-}
-
-tree
-AstArrTypeNode::getSym(
-    const char* name,
-    SymTable& symTable
-    ) const
-{
-    int off;
-    return symTable.getArr(
-        name, off );
-}
-
 bool
 AstArrTypeNode::addSym(
-    const char* name,
-    tree decl,
+    const Ident* name,
+    AstSym* sym,
     SymTable& symTable
     ) const
 {
+    sym->off = -mBegin;
     return symTable.addArr(
-        name, -mBegin, decl );
+        name, sym );
 }
 
 void
@@ -120,21 +99,46 @@ AstArrTypeNode::print(
     mElemType->print( off + 1, fp );
 }
 
+bool
+AstArrTypeNode::bind(
+    SymTable& symTable
+    )
+{
+    return mElemType->bind( symTable );
+}
+
 bool
 AstArrTypeNode::translate(
     tree& t,
-    tree ctx,
-    SymTable& symTable
+    tree ctx
     ) const
 {
-    tree elemType;
-    if( !mElemType->translate( elemType, ctx, symTable ) )
-        return false;
+    if( NULL_TREE == mTree )
+    {
+        tree elemType;
+        if( !mElemType->translate( elemType, ctx ) )
+            return false;
+
+        mTree = build_array_type(
+            elemType,
+            build_index_type(
+                size_int( mEnd - mBegin ) ) );
+        register_global_tree( mTree );
+    }
+
+    t = mTree;
+    return true;
+}
 
-    t = build_array_type(
-        elemType,
-        build_index_type(
-            size_int( mEnd - mBegin ) ) );
+uint32_t
+AstArrTypeNode::flatten(
+    AstFlat& flat
+    ) const
+{
+    uint32_t elemType = mElemType->flatten( flat );
 
-    return true;
+    return flat.addNode(
+        ASTFLAT_ARR_TYPE, mLoc, LEXTOK_EOI,
+        static_cast< uint32_t >( mBegin ),
+        static_cast< uint32_t >( mEnd ), elemType );
 }
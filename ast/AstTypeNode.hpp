@@ -9,6 +9,7 @@
 #define SFE__AST__AST_TYPE_NODE_HPP__INCL__
 
 #include "ast/AstNode.hpp"
+#include "parser/IdentTable.hpp"
 
 /**
  * @brief A generic type node.
@@ -19,38 +20,14 @@ class AstTypeNode
 : public AstNode
 {
 public:
-    /**
-     * @brief Clones the node.
-     *
-     * @return
-     *   Clone of the node.
-     */
-    virtual AstTypeNode* clone() const = 0;
-
-    /**
-     * @brief Looks up a symbol according
-     *  to the type.
-     *
-     * @param[in] name
-     *   Name of the symbol.
-     * @param[in] symTable
-     *   The SymTable to use.
-     *
-     * @return
-     *   Whatever returned by SymTable.
-     */
-    virtual tree getSym(
-        const char* name,
-        SymTable& symTable
-        ) const = 0;
     /**
      * @brief Registers a symbol according
      *  to the type.
      *
      * @param[in] name
      *   Name of the symbol.
-     * @param[in] decl
-     *   Declaration of the symbol.
+     * @param[in] sym
+     *   Slot of the symbol.
      * @param[in] symTable
      *   The SymTable to use.
      *
@@ -58,8 +35,8 @@ public:
      *   Whatever returned by SymTable.
      */
     virtual bool addSym(
-        const char* name,
-        tree decl,
+        const Ident* name,
+        AstSym* sym,
         SymTable& symTable
         ) const = 0;
 };
@@ -73,38 +50,14 @@ class AstIntTypeNode
 : public AstTypeNode
 {
 public:
-    /**
-     * @brief Clones the node.
-     *
-     * @return
-     *   Clone of the node.
-     */
-    AstTypeNode* clone() const;
-
-    /**
-     * @brief Looks up a symbol according
-     *  to the type.
-     *
-     * @param[in] name
-     *   Name of the symbol.
-     * @param[in] symTable
-     *   The SymTable to use.
-     *
-     * @return
-     *   Whatever returned by SymTable.
-     */
-    tree getSym(
-        const char* name,
-        SymTable& symTable
-        ) const;
     /**
      * @brief Registers a symbol according
      *  to the type.
      *
      * @param[in] name
      *   Name of the symbol.
-     * @param[in] decl
-     *   Declaration of the symbol.
+     * @param[in] sym
+     *   Slot of the symbol.
      * @param[in] symTable
      *   The SymTable to use.
      *
@@ -112,8 +65,8 @@ public:
      *   Whatever returned by SymTable.
      */
     bool addSym(
-        const char* name,
-        tree decl,
+        const Ident* name,
+        AstSym* sym,
         SymTable& symTable
         ) const;
 
@@ -129,6 +82,18 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Creates an appropriate type node.
      *
@@ -136,8 +101,6 @@ public:
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -146,9 +109,18 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
 };
 
 /**
@@ -175,43 +147,15 @@ public:
         int end,
         AstTypeNode* elemType
         );
-    /**
-     * @brief Frees the array element type.
-     */
-    ~AstArrTypeNode();
-
-    /**
-     * @brief Clones the node.
-     *
-     * @return
-     *   Clone of the node.
-     */
-    AstTypeNode* clone() const;
 
-    /**
-     * @brief Looks up a symbol according
-     *  to the type.
-     *
-     * @param[in] name
-     *   Name of the symbol.
-     * @param[in] symTable
-     *   The SymTable to use.
-     *
-     * @return
-     *   Whatever returned by SymTable.
-     */
-    tree getSym(
-        const char* name,
-        SymTable& symTable
-        ) const;
     /**
      * @brief Registers a symbol according
      *  to the type.
      *
      * @param[in] name
      *   Name of the symbol.
-     * @param[in] decl
-     *   Declaration of the symbol.
+     * @param[in] sym
+     *   Slot of the symbol.
      * @param[in] symTable
      *   The SymTable to use.
      *
@@ -219,8 +163,8 @@ public:
      *   Whatever returned by SymTable.
      */
     bool addSym(
-        const char* name,
-        tree decl,
+        const Ident* name,
+        AstSym* sym,
         SymTable& symTable
         ) const;
 
@@ -236,15 +180,28 @@ public:
         unsigned int off,
         FILE* fp
         ) const;
+    /**
+     * @brief Resolves names in the node.
+     *
+     * @param[in,out] symTable
+     *   A symbol table.
+     *
+     * @retval true
+     *   All names resolved.
+     * @retval false
+     *   Resolution failed.
+     */
+    bool bind( SymTable& symTable );
     /**
      * @brief Translates to appropriate array type.
      *
+     * The type is built only once; the node is shared
+     * by all declarations of the same type.
+     *
      * @param[out] t
      *   Where to store the translated tree.
      * @param[in,out] ctx
      *   Context in which the node appears.
-     * @param[in,out] symTable
-     *   A symbol table.
      *
      * @retval true
      *   Translation successful.
@@ -253,9 +210,18 @@ public:
      */
     bool translate(
         tree& t,
-        tree ctx,
-        SymTable& symTable
+        tree ctx
         ) const;
+    /**
+     * @brief Appends the node to a flat AST.
+     *
+     * @param[in,out] flat
+     *   The flat AST to append to.
+     *
+     * @return
+     *   Index of the node.
+     */
+    uint32_t flatten( AstFlat& flat ) const;
 
 protected:
     /// Begin index.
@@ -265,6 +231,8 @@ protected:
 
     /// Array element type.
     AstTypeNode* mElemType;
+    /// The translated type (a GC root), or NULL_TREE if none yet.
+    mutable tree mTree;
 };
 
 #endif /* !SFE__AST__AST_TYPE_NODE_HPP__INCL__ */
@@ -7,6 +7,7 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 #include "sfe-lang.h"
 
@@ -24,6 +25,13 @@ register_global_variable_declaration(
 {
 }
 
+void
+register_global_tree(
+    tree t
+    )
+{
+}
+
 int
 main(
     int argc,
@@ -31,15 +39,29 @@ main(
     )
 {
     FILE* fp;
+    AstArena arena;
+    bool threaded = false;
+    bool flat = false;
 
     if( argc < 2 )
     {
-        fprintf( stderr, "Usage: %s <source.p> [...]\n", *argv );
+        fprintf( stderr, "Usage: %s [-fthreaded-lexer] [-fflat-ast] <source.p> [...]\n", *argv );
         return EXIT_FAILURE;
     }
 
     for( int i = 1; i < argc; ++i )
     {
+        if( !strcmp( argv[i], "-fthreaded-lexer" ) )
+        {
+            threaded = true;
+            continue;
+        }
+        if( !strcmp( argv[i], "-fflat-ast" ) )
+        {
+            flat = true;
+            continue;
+        }
+
         printf( "Parsing `%s'\n", argv[i] );
 
         if( !(fp = fopen( argv[i], "r" )) )
@@ -49,28 +71,64 @@ main(
         }
 
         LexAnalyzer lexan( fp );
-        Parser parser( lexan );
+        LexThread lexthr( lexan );
+        Parser parser( threaded
+                       ? static_cast< LexSource& >( lexthr )
+                       : static_cast< LexSource& >( lexan ),
+                       arena );
 
         AstNode* ast;
         if( !parser.parse( ast ) )
         {
             printf( "Failed to parse file `%s'\n", argv[i] );
+            arena.reset();
             continue;
         }
 
         printf( "File `%s' parsed successfully\n", argv[i] );
+
+        // Both the tree and the flat AST get folded.
+        AstFold folder( arena );
+        ast = ast->foldConst( folder );
+#ifdef DEBUG_FOLD
+        fprintf( stderr, "AST fold: %lu nodes folded\n",
+                 folder.folded() );
+#endif /* DEBUG_FOLD */
+
 #ifdef DEBUG_AST
         ast->print( 1, stdout );
 #endif /* DEBUG_AST */
 
-        if( !ast->translate() )
+        bool translated;
+        if( flat )
+        {
+            AstFlat flatAst( *ast );
+#ifdef DEBUG_ARENA
+            fprintf( stderr, "Flat AST: %lu nodes, %lu bytes\n",
+                     static_cast< unsigned long >( flatAst.size() ),
+                     static_cast< unsigned long >( flatAst.usedBytes() ) );
+#endif /* DEBUG_ARENA */
+
+            // The flat AST does not need the arena.
+            arena.reset();
+            translated = flatAst.translate();
+        }
+        else
+            translated = ast->bind() && ast->translate();
+
+        if( !translated )
         {
             printf( "Failed to translate file `%s'\n", argv[i] );
-            delete ast;
+            arena.reset();
             continue;
         }
 
         printf( "File `%s' translated successfully\n", argv[i] );
-        delete ast;
+        arena.reset();
     }
+
+#ifdef DEBUG_ARENA
+    fprintf( stderr, "AST arena peak: %lu bytes\n",
+             static_cast< unsigned long >( arena.peakBytes() ) );
+#endif /* DEBUG_ARENA */
 }
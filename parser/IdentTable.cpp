@@ -0,0 +1,148 @@
+/** @file
+ * @brief Definition of the identifier table.
+ *
+ * @author Jan Bobek
+ * @since 16th October 2026
+ */
+
+#include <cstring>
+
+#include "parser/IdentTable.hpp"
+
+/// Initial number of hash slots; must be a power of two.
+static const size_t IDENT_TABLE_SLOTS = 1024;
+/// Size of a memory chunk holding the identifiers.
+static const size_t IDENT_TABLE_CHUNK = 64 * 1024;
+
+/*************************************************************************/
+/* IdentTable                                                            */
+/*************************************************************************/
+IdentTable&
+IdentTable::global()
+{
+    static IdentTable table;
+    return table;
+}
+
+IdentTable::IdentTable()
+: mSlots( IDENT_TABLE_SLOTS, static_cast< Ident* >( NULL ) ),
+  mCount( 0 ),
+  mFree( NULL ),
+  mFreeEnd( NULL )
+{
+}
+
+IdentTable::~IdentTable()
+{
+    std::vector< char* >::iterator cur, end;
+    cur = mChunks.begin();
+    end = mChunks.end();
+    for(; cur != end; ++cur )
+        delete[] *cur;
+}
+
+const Ident*
+IdentTable::intern(
+    const char* str
+    )
+{
+    return intern( str, strlen( str ) );
+}
+
+const Ident*
+IdentTable::intern(
+    const char* str,
+    size_t len
+    )
+{
+    unsigned int h = hash( str, len );
+    size_t mask = mSlots.size() - 1;
+    size_t i = h & mask;
+
+    // Linear probing; the table is never more than half full.
+    for(; NULL != mSlots[i]; i = (i + 1) & mask )
+    {
+        const Ident* ident = mSlots[i];
+        if( ident->hash == h && ident->len == len &&
+            0 == memcmp( ident->str, str, len ) )
+            return ident;
+    }
+
+    char* mem = allocate( sizeof( Ident ) + len + 1 );
+    char* spelling = mem + sizeof( Ident );
+    memcpy( spelling, str, len );
+    spelling[len] = '\0';
+
+    Ident* ident = reinterpret_cast< Ident* >( mem );
+    ident->str = spelling;
+    ident->len = len;
+    ident->hash = h;
+
+    mSlots[i] = ident;
+    if( mSlots.size() < 2 * ++mCount )
+        grow();
+
+    return ident;
+}
+
+unsigned int
+IdentTable::hash(
+    const char* str,
+    size_t len
+    )
+{
+    // FNV-1a
+    unsigned int h = 2166136261u;
+    for( size_t i = 0; i < len; ++i )
+        h = (h ^ static_cast< unsigned char >( str[i] )) * 16777619u;
+
+    return h;
+}
+
+char*
+IdentTable::allocate(
+    size_t size
+    )
+{
+    // Keep the identifiers aligned.
+    size = (size + sizeof( void* ) - 1) & ~(sizeof( void* ) - 1);
+
+    if( static_cast< size_t >( mFreeEnd - mFree ) < size )
+    {
+        size_t chunk = IDENT_TABLE_CHUNK < size
+            ? size : IDENT_TABLE_CHUNK;
+
+        mFree = new char[chunk];
+        mFreeEnd = mFree + chunk;
+        mChunks.push_back( mFree );
+    }
+
+    char* mem = mFree;
+    mFree += size;
+    return mem;
+}
+
+void
+IdentTable::grow()
+{
+    std::vector< Ident* > slots(
+        2 * mSlots.size(), static_cast< Ident* >( NULL ) );
+    size_t mask = slots.size() - 1;
+
+    std::vector< Ident* >::const_iterator cur, end;
+    cur = mSlots.begin();
+    end = mSlots.end();
+    for(; cur != end; ++cur )
+    {
+        if( NULL == *cur )
+            continue;
+
+        size_t i = (*cur)->hash & mask;
+        while( NULL != slots[i] )
+            i = (i + 1) & mask;
+
+        slots[i] = *cur;
+    }
+
+    mSlots.swap( slots );
+}
@@ -0,0 +1,133 @@
+/** @file
+ * @brief Declaration of the identifier table.
+ *
+ * @author Jan Bobek
+ * @since 16th October 2026
+ */
+
+#ifndef SFE__PARSER__IDENT_TABLE_HPP__INCL__
+#define SFE__PARSER__IDENT_TABLE_HPP__INCL__
+
+#include <cstddef>
+
+#include <vector>
+
+/**
+ * @brief An interned identifier.
+ *
+ * There is exactly one Ident per distinct spelling,
+ * so identifiers compare equal iff their pointers do.
+ *
+ * @author Jan Bobek
+ */
+struct Ident
+{
+    /// The NUL-terminated spelling.
+    const char* str;
+    /// Length of the spelling.
+    unsigned int len;
+    /// Hash of the spelling.
+    unsigned int hash;
+};
+
+/**
+ * @brief A table of interned identifiers.
+ *
+ * The table is not synchronized; only one
+ * thread at a time may intern identifiers.
+ *
+ * @author Jan Bobek
+ */
+class IdentTable
+{
+public:
+    /**
+     * @brief Obtains the table shared by the lexical
+     *   analyzer, the AST and the symbol table.
+     *
+     * @return
+     *   The global table.
+     */
+    static IdentTable& global();
+
+    /**
+     * @brief Initializes an empty table.
+     */
+    IdentTable();
+    /**
+     * @brief Frees all the identifiers.
+     */
+    ~IdentTable();
+
+    /**
+     * @brief Interns a NUL-terminated string.
+     *
+     * @param[in] str
+     *   The string to intern.
+     *
+     * @return
+     *   The interned identifier.
+     */
+    const Ident* intern( const char* str );
+    /**
+     * @brief Interns a string.
+     *
+     * @param[in] str
+     *   The string to intern.
+     * @param[in] len
+     *   Length of the string.
+     *
+     * @return
+     *   The interned identifier.
+     */
+    const Ident* intern(
+        const char* str,
+        size_t len
+        );
+
+protected:
+    /**
+     * @brief Hashes a string.
+     *
+     * @param[in] str
+     *   The string to hash.
+     * @param[in] len
+     *   Length of the string.
+     *
+     * @return
+     *   Hash of the string.
+     */
+    static unsigned int hash(
+        const char* str,
+        size_t len
+        );
+
+    /**
+     * @brief Allocates memory for a new identifier.
+     *
+     * @param[in] size
+     *   Number of bytes to allocate.
+     *
+     * @return
+     *   The allocated memory.
+     */
+    char* allocate( size_t size );
+    /**
+     * @brief Doubles the number of hash slots.
+     */
+    void grow();
+
+    /// The hash slots.
+    std::vector< Ident* > mSlots;
+    /// Number of identifiers in the table.
+    size_t mCount;
+
+    /// Memory chunks holding the identifiers.
+    std::vector< char* > mChunks;
+    /// Free space in the last chunk.
+    char* mFree;
+    /// End of the last chunk.
+    char* mFreeEnd;
+};
+
+#endif /* !SFE__PARSER__IDENT_TABLE_HPP__INCL__ */
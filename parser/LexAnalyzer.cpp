@@ -5,11 +5,465 @@
  * @since 30th May 2014
  */
 
-#include <cctype>
+#include <cstdarg>
+#include <cstdlib>
 #include <cstring>
 
+#ifdef __SSE2__
+#   include <emmintrin.h>
+#endif /* __SSE2__ */
+
+// AVX2 is selected at run time, so it needs
+// the target attribute (GCC 4.9 and newer).
+#if ( defined( __x86_64__ ) || defined( __i386__ ) ) &&    \
+    ( 4 < __GNUC__ || ( 4 == __GNUC__ && 9 <= __GNUC_MINOR__ ) )
+#   define LEX_AVX2
+#   include <immintrin.h>
+#endif /* LEX_AVX2 */
+
+// Eight digits are converted at once from a little-endian word.
+#if defined( __BYTE_ORDER__ ) &&                             \
+    __ORDER_LITTLE_ENDIAN__ == __BYTE_ORDER__
+#   define LEX_SWAR
+#endif /* LEX_SWAR */
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif /* __unix__ || __APPLE__ */
+
 #include "parser/LexAnalyzer.hpp"
 
+/// Size of a block read from an unmappable stream.
+static const size_t LEX_READ_BLOCK = 64 * 1024;
+/// Length of a character run scanned one char at a time.
+static const ptrdiff_t LEX_SHORT_RUN = 8;
+/// Length of a search after which AVX2 pays off.
+static const ptrdiff_t LEX_LONG_RUN = 64;
+/// The largest value of a lexelem intval.
+static const int64_t LEX_INT_MAX = 0x7FFFFFFFFFFFFFFFLL;
+
+/**
+ * @brief Character classes of the input alphabet.
+ *
+ * @author Jan Bobek
+ */
+enum LexCharClass
+{
+    LEXCC_SPACE = 0x01, ///< White space.
+    LEXCC_ALPHA = 0x02, ///< A letter or underscore.
+    LEXCC_DIGIT = 0x04, ///< A decimal digit.
+    LEXCC_OCT   = 0x08, ///< An octal digit.
+    LEXCC_HEX   = 0x10, ///< A hexadecimal digit.
+
+    LEXCC_ALNUM = LEXCC_ALPHA | LEXCC_DIGIT ///< An identifier character.
+};
+
+/// Classes of the input characters, independent of
+/// the locale; the omitted entries above 0x7F are zero.
+static const unsigned char LEX_CHAR_CLASS[256] =
+{
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x00
+    0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, // 0x08
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x10
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x18
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x20
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x28
+    0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, // 0x30
+    0x14, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x38
+    0x00, 0x12, 0x12, 0x12, 0x12, 0x12, 0x12, 0x02, // 0x40
+    0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, // 0x48
+    0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, // 0x50
+    0x02, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00, 0x02, // 0x58
+    0x00, 0x12, 0x12, 0x12, 0x12, 0x12, 0x12, 0x02, // 0x60
+    0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, // 0x68
+    0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, // 0x70
+    0x02, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x78
+};
+
+/// Tokens of the single-char symbols; LEXTOK_EOI if none.
+/// The omitted entries above 0x5F are zero.
+static const LexToken LEX_CHAR_TOKEN[256] =
+{
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x00
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x04
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x08
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x0C
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x10
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x14
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x18
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x1C
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x20
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x24
+    LEXTOK_LPAR,   LEXTOK_RPAR,   LEXTOK_MULT,   LEXTOK_PLUS,  // 0x28
+    LEXTOK_COMMA,  LEXTOK_MINUS,  LEXTOK_DOT,    LEXTOK_DIV,   // 0x2C
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x30
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x34
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_COL,    LEXTOK_SCOL,  // 0x38
+    LEXTOK_LT,     LEXTOK_EQ,     LEXTOK_GT,     LEXTOK_EOI,   // 0x3C
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x40
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x44
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x48
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x4C
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x50
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,   // 0x54
+    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_EOI,    LEXTOK_LBRA,  // 0x58
+    LEXTOK_EOI,    LEXTOK_RBRA,   LEXTOK_EOI,    LEXTOK_EOI,   // 0x5C
+};
+
+/**
+ * @brief Checks the class of a character.
+ *
+ * @param[in] c
+ *   The character; may be EOF.
+ * @param[in] cls
+ *   Mask of the classes to check for.
+ *
+ * @retval true
+ *   The character belongs to one of the classes.
+ * @retval false
+ *   It does not, or it is EOF.
+ */
+static inline bool
+lexCharIs(
+    int c,
+    unsigned int cls
+    )
+{
+    return EOF != c && 0 != (LEX_CHAR_CLASS[c] & cls);
+}
+
+#ifdef __SSE2__
+/**
+ * @brief Finds the white space characters in
+ *   a block of 16 characters.
+ *
+ * @param[in] block
+ *   The block to scan.
+ *
+ * @return
+ *   Bitmask of the white space characters.
+ */
+static inline unsigned int
+lexSpaceMask(
+    __m128i block
+    )
+{
+    // Shift '\t' .. '\r' to the bottom of the signed range.
+    __m128i ctl = _mm_add_epi8( block, _mm_set1_epi8( 0x80 - '\t' ) );
+    __m128i sp = _mm_or_si128(
+        _mm_cmpeq_epi8( block, _mm_set1_epi8( ' ' ) ),
+        _mm_cmplt_epi8( ctl, _mm_set1_epi8( -0x80 + '\r' - '\t' + 1 ) ) );
+
+    return _mm_movemask_epi8( sp );
+}
+
+/**
+ * @brief Finds the identifier characters in
+ *   a block of 16 characters.
+ *
+ * @param[in] block
+ *   The block to scan.
+ *
+ * @return
+ *   Bitmask of the identifier characters.
+ */
+static inline unsigned int
+lexAlnumMask(
+    __m128i block
+    )
+{
+    // Fold to lower case, then shift each range to
+    // the bottom of the signed range as above.
+    __m128i lower = _mm_or_si128( block, _mm_set1_epi8( 0x20 ) );
+    __m128i alpha = _mm_cmplt_epi8(
+        _mm_add_epi8( lower, _mm_set1_epi8( 0x80 - 'a' ) ),
+        _mm_set1_epi8( -0x80 + 'z' - 'a' + 1 ) );
+    __m128i digit = _mm_cmplt_epi8(
+        _mm_add_epi8( block, _mm_set1_epi8( 0x80 - '0' ) ),
+        _mm_set1_epi8( -0x80 + '9' - '0' + 1 ) );
+    __m128i under = _mm_cmpeq_epi8( block, _mm_set1_epi8( '_' ) );
+
+    return _mm_movemask_epi8(
+        _mm_or_si128( _mm_or_si128( alpha, digit ), under ) );
+}
+#endif /* __SSE2__ */
+
+/**
+ * @brief Skips white space.
+ *
+ * @param[in] cur
+ *   Where to start.
+ * @param[in] end
+ *   End of the input.
+ *
+ * @return
+ *   The first character which is not white space.
+ */
+static inline const char*
+lexSkipSpace(
+    const char* cur,
+    const char* end
+    )
+{
+    // Most runs are short; only long ones are worth
+    // scanning in blocks.
+    const char* stop = end - cur < LEX_SHORT_RUN
+        ? end : cur + LEX_SHORT_RUN;
+    for(; cur < stop; ++cur )
+        if( 0 == (LEX_CHAR_CLASS[
+                      static_cast< unsigned char >( *cur )] & LEXCC_SPACE) )
+            return cur;
+
+#ifdef __SSE2__
+    for(; 16 <= end - cur; cur += 16 )
+    {
+        __m128i block = _mm_loadu_si128(
+            reinterpret_cast< const __m128i* >( cur ) );
+
+        unsigned int mask = ~lexSpaceMask( block ) & 0xFFFF;
+        if( 0 != mask )
+            return cur + __builtin_ctz( mask );
+    }
+#endif /* __SSE2__ */
+
+    while( cur < end && 0 != (LEX_CHAR_CLASS[
+               static_cast< unsigned char >( *cur )] & LEXCC_SPACE) )
+        ++cur;
+
+    return cur;
+}
+
+/**
+ * @brief Skips identifier characters.
+ *
+ * @param[in] cur
+ *   Where to start.
+ * @param[in] end
+ *   End of the input.
+ *
+ * @return
+ *   The first character which cannot be
+ *   part of an identifier.
+ */
+static inline const char*
+lexSkipAlnum(
+    const char* cur,
+    const char* end
+    )
+{
+    // Most runs are short; only long ones are worth
+    // scanning in blocks.
+    const char* stop = end - cur < LEX_SHORT_RUN
+        ? end : cur + LEX_SHORT_RUN;
+    for(; cur < stop; ++cur )
+        if( 0 == (LEX_CHAR_CLASS[
+                      static_cast< unsigned char >( *cur )] & LEXCC_ALNUM) )
+            return cur;
+
+#ifdef __SSE2__
+    for(; 16 <= end - cur; cur += 16 )
+    {
+        __m128i block = _mm_loadu_si128(
+            reinterpret_cast< const __m128i* >( cur ) );
+
+        unsigned int mask = ~lexAlnumMask( block ) & 0xFFFF;
+        if( 0 != mask )
+            return cur + __builtin_ctz( mask );
+    }
+#endif /* __SSE2__ */
+
+    while( cur < end && 0 != (LEX_CHAR_CLASS[
+               static_cast< unsigned char >( *cur )] & LEXCC_ALNUM) )
+        ++cur;
+
+    return cur;
+}
+
+#ifdef LEX_AVX2
+/**
+ * @brief Checks whether the CPU supports AVX2.
+ *
+ * @retval true
+ *   AVX2 is supported.
+ * @retval false
+ *   AVX2 is not supported.
+ */
+static bool
+lexHasAvx2()
+{
+    static const bool has = ( __builtin_cpu_init(),
+                              0 != __builtin_cpu_supports( "avx2" ) );
+    return has;
+}
+
+/**
+ * @brief Finds a character using AVX2.
+ *
+ * @param[in] cur
+ *   Where to start.
+ * @param[in] end
+ *   End of the input.
+ * @param[in] c
+ *   The character to find.
+ *
+ * @return
+ *   The first occurrence of the character,
+ *   or @p end if there is none.
+ */
+__attribute__(( target( "avx2" ) ))
+static const char*
+lexFindByteAvx2(
+    const char* cur,
+    const char* end,
+    char c
+    )
+{
+    const __m256i needle = _mm256_set1_epi8( c );
+
+    for(; 32 <= end - cur; cur += 32 )
+    {
+        __m256i block = _mm256_loadu_si256(
+            reinterpret_cast< const __m256i* >( cur ) );
+
+        unsigned int mask = _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8( block, needle ) );
+        if( 0 != mask )
+            return cur + __builtin_ctz( mask );
+    }
+
+    while( cur < end && c != *cur )
+        ++cur;
+
+    return cur;
+}
+#endif /* LEX_AVX2 */
+
+/**
+ * @brief Finds a character.
+ *
+ * Used to find the end of string literals and comments.
+ *
+ * @param[in] cur
+ *   Where to start.
+ * @param[in] end
+ *   End of the input.
+ * @param[in] c
+ *   The character to find.
+ *
+ * @return
+ *   The first occurrence of the character,
+ *   or @p end if there is none.
+ */
+static inline const char*
+lexFindByte(
+    const char* cur,
+    const char* end,
+    char c
+    )
+{
+#ifdef __SSE2__
+    const __m128i needle = _mm_set1_epi8( c );
+
+    // Most strings are short; SSE2 wins over AVX2 there.
+    const char* stop = end - cur < LEX_LONG_RUN
+        ? end : cur + LEX_LONG_RUN;
+    for(; 16 <= stop - cur; cur += 16 )
+    {
+        __m128i block = _mm_loadu_si128(
+            reinterpret_cast< const __m128i* >( cur ) );
+
+        unsigned int mask = _mm_movemask_epi8(
+            _mm_cmpeq_epi8( block, needle ) );
+        if( 0 != mask )
+            return cur + __builtin_ctz( mask );
+    }
+#endif /* __SSE2__ */
+
+#ifdef LEX_AVX2
+    if( 32 <= end - cur && lexHasAvx2() )
+        return lexFindByteAvx2( cur, end, c );
+#endif /* LEX_AVX2 */
+
+#ifdef __SSE2__
+    for(; 16 <= end - cur; cur += 16 )
+    {
+        __m128i block = _mm_loadu_si128(
+            reinterpret_cast< const __m128i* >( cur ) );
+
+        unsigned int mask = _mm_movemask_epi8(
+            _mm_cmpeq_epi8( block, needle ) );
+        if( 0 != mask )
+            return cur + __builtin_ctz( mask );
+    }
+#endif /* __SSE2__ */
+
+    while( cur < end && c != *cur )
+        ++cur;
+
+    return cur;
+}
+
+#ifdef LEX_SWAR
+/// Powers of ten by the number of converted digits.
+static const int64_t LEX_POW10[] =
+{
+    1, 10, 100, 1000, 10000, 100000,
+    1000000, 10000000, 100000000
+};
+
+/**
+ * @brief Converts up to eight decimal digits at once.
+ *
+ * @param[in] cur
+ *   The digits; at least eight chars must be readable.
+ * @param[out] val
+ *   Value of the converted digits.
+ *
+ * @return
+ *   Number of the converted digits.
+ */
+static inline unsigned int
+lexSwarDigits(
+    const char* cur,
+    int64_t& val
+    )
+{
+    uint64_t w;
+    memcpy( &w, cur, sizeof( w ) );
+
+    // A byte is a digit iff both it and the byte plus 6
+    // have 3 in the high nibble. Carries only spill past
+    // the first non-digit, where they do not matter.
+    uint64_t nondigit =
+        ((w & 0xF0F0F0F0F0F0F0F0ULL) ^ 0x3030303030303030ULL) |
+        (((w + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL)
+         ^ 0x3030303030303030ULL);
+
+    unsigned int n = 0 == nondigit
+        ? 8 : __builtin_ctzll( nondigit ) / 8;
+    if( 0 == n )
+    {
+        val = 0;
+        return 0;
+    }
+
+    // Drop the non-digits and move the digits to the top,
+    // so that the number is padded with leading zeros.
+    w = (w - 0x3030303030303030ULL) << (8 * (8 - n));
+
+    // Combine adjacent digits, then pairs, then quads.
+    w = w * 10 + (w >> 8);
+    w = ((w & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)) +
+         ((w >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))
+        >> 32;
+
+    val = static_cast< int64_t >( w );
+    return n;
+}
+#endif /* LEX_SWAR */
+
 const char* const LEXTOK_STR[] =
 {
     "end of input", // LEXTOK_EOI
@@ -77,68 +531,211 @@ const char* const LEXTOK_STR[] =
     "keyword writeln", // LEXTOK_KW_WRITELN
 };
 
-// Must be sorted alphabetically!
+// Indexed by lexKeywordHash(); a build with DEBUG_LEXER
+// checks the slots at startup.
 const LexKeyword LEX_KEYWORDS[] =
 {
-    { "and",       LEXTOK_AND },
-    { "array",     LEXTOK_KW_ARR },
-    { "begin",     LEXTOK_KW_BEGIN },
-    { "const",     LEXTOK_KW_CONST },
-    { "dec",       LEXTOK_KW_DEC },
-    { "div",       LEXTOK_DIV },
-    { "do",        LEXTOK_KW_DO },
-    { "downto",    LEXTOK_KW_DWNTO },
-    { "else",      LEXTOK_KW_ELSE },
-    { "end",       LEXTOK_KW_END },
-    { "exit",      LEXTOK_KW_EXIT },
-    { "for",       LEXTOK_KW_FOR },
-    { "forward",   LEXTOK_KW_FWD },
-    { "function",  LEXTOK_KW_FUNC },
-    { "if",        LEXTOK_KW_IF },
-    { "inc",       LEXTOK_KW_INC },
-    { "integer",   LEXTOK_KW_INT },
-    { "mod",       LEXTOK_MOD },
-    { "of",        LEXTOK_KW_OF },
-    { "or",        LEXTOK_OR },
-    { "procedure", LEXTOK_KW_PROC },
-    { "program",   LEXTOK_KW_PROG },
-    { "readln",    LEXTOK_KW_READLN },
-    { "then",      LEXTOK_KW_THEN },
-    { "to",        LEXTOK_KW_TO },
-    { "var",       LEXTOK_KW_VAR },
-    { "while",     LEXTOK_KW_WHILE },
-    { "write",     LEXTOK_KW_WRITE },
-    { "writeln",   LEXTOK_KW_WRITELN },
+    { "const",     5, LEXTOK_KW_CONST },      //  0
+    { NULL,        0, LEXTOK_IDENT },         //  1
+    { NULL,        0, LEXTOK_IDENT },         //  2
+    { NULL,        0, LEXTOK_IDENT },         //  3
+    { NULL,        0, LEXTOK_IDENT },         //  4
+    { NULL,        0, LEXTOK_IDENT },         //  5
+    { NULL,        0, LEXTOK_IDENT },         //  6
+    { NULL,        0, LEXTOK_IDENT },         //  7
+    { NULL,        0, LEXTOK_IDENT },         //  8
+    { "writeln",   7, LEXTOK_KW_WRITELN },    //  9
+    { NULL,        0, LEXTOK_IDENT },         // 10
+    { NULL,        0, LEXTOK_IDENT },         // 11
+    { "then",      4, LEXTOK_KW_THEN },       // 12
+    { NULL,        0, LEXTOK_IDENT },         // 13
+    { NULL,        0, LEXTOK_IDENT },         // 14
+    { NULL,        0, LEXTOK_IDENT },         // 15
+    { NULL,        0, LEXTOK_IDENT },         // 16
+    { "downto",    6, LEXTOK_KW_DWNTO },      // 17
+    { NULL,        0, LEXTOK_IDENT },         // 18
+    { NULL,        0, LEXTOK_IDENT },         // 19
+    { NULL,        0, LEXTOK_IDENT },         // 20
+    { "do",        2, LEXTOK_KW_DO },         // 21
+    { "if",        2, LEXTOK_KW_IF },         // 22
+    { NULL,        0, LEXTOK_IDENT },         // 23
+    { NULL,        0, LEXTOK_IDENT },         // 24
+    { "procedure", 9, LEXTOK_KW_PROC },       // 25
+    { "dec",       3, LEXTOK_KW_DEC },        // 26
+    { NULL,        0, LEXTOK_IDENT },         // 27
+    { NULL,        0, LEXTOK_IDENT },         // 28
+    { "and",       3, LEXTOK_AND },           // 29
+    { "div",       3, LEXTOK_DIV },           // 30
+    { NULL,        0, LEXTOK_IDENT },         // 31
+    { NULL,        0, LEXTOK_IDENT },         // 32
+    { "while",     5, LEXTOK_KW_WHILE },      // 33
+    { "of",        2, LEXTOK_KW_OF },         // 34
+    { "readln",    6, LEXTOK_KW_READLN },     // 35
+    { "forward",   7, LEXTOK_KW_FWD },        // 36
+    { "end",       3, LEXTOK_KW_END },        // 37
+    { NULL,        0, LEXTOK_IDENT },         // 38
+    { NULL,        0, LEXTOK_IDENT },         // 39
+    { "for",       3, LEXTOK_KW_FOR },        // 40
+    { "integer",   7, LEXTOK_KW_INT },        // 41
+    { NULL,        0, LEXTOK_IDENT },         // 42
+    { "write",     5, LEXTOK_KW_WRITE },      // 43
+    { NULL,        0, LEXTOK_IDENT },         // 44
+    { "inc",       3, LEXTOK_KW_INC },        // 45
+    { "or",        2, LEXTOK_OR },            // 46
+    { NULL,        0, LEXTOK_IDENT },         // 47
+    { NULL,        0, LEXTOK_IDENT },         // 48
+    { NULL,        0, LEXTOK_IDENT },         // 49
+    { "else",      4, LEXTOK_KW_ELSE },       // 50
+    { NULL,        0, LEXTOK_IDENT },         // 51
+    { "begin",     5, LEXTOK_KW_BEGIN },      // 52
+    { "to",        2, LEXTOK_KW_TO },         // 53
+    { "mod",       3, LEXTOK_MOD },           // 54
+    { NULL,        0, LEXTOK_IDENT },         // 55
+    { NULL,        0, LEXTOK_IDENT },         // 56
+    { "function",  8, LEXTOK_KW_FUNC },       // 57
+    { "var",       3, LEXTOK_KW_VAR },        // 58
+    { "program",   7, LEXTOK_KW_PROG },       // 59
+    { NULL,        0, LEXTOK_IDENT },         // 60
+    { NULL,        0, LEXTOK_IDENT },         // 61
+    { "exit",      4, LEXTOK_KW_EXIT },       // 62
+    { "array",     5, LEXTOK_KW_ARR },        // 63
 };
 
 const unsigned int LEX_KEYWORD_COUNT =
     sizeof(LEX_KEYWORDS) / sizeof(*LEX_KEYWORDS);
 
+/**
+ * @brief Hashes a keyword candidate.
+ *
+ * The hash is perfect over the keyword set, so any
+ * string is either the keyword in its slot or none.
+ *
+ * @param[in] str
+ *   The string to hash.
+ * @param[in] len
+ *   Length of the string; at least 2.
+ *
+ * @return
+ *   Slot of the string in LEX_KEYWORDS.
+ */
+static inline unsigned int
+lexKeywordHash(
+    const char* str,
+    size_t len
+    )
+{
+    return (15 * len
+            + 2 * static_cast< unsigned char >( str[0] )
+            + static_cast< unsigned char >( str[1] ))
+        & (LEX_KEYWORD_COUNT - 1);
+}
+
 LexToken
 lexKeywordLookup(
-    const char* str
+    const char* str,
+    size_t len
     )
 {
-    int res;
-    unsigned int l, r, m;
+    // There are no one-letter keywords.
+    if( len < 2 )
+        return LEXTOK_IDENT;
+
+    const LexKeyword& kw =
+        LEX_KEYWORDS[lexKeywordHash( str, len )];
 
-    l = 0;
-    r = LEX_KEYWORD_COUNT;
-    while( l < r )
+    return kw.length == len && 0 == memcmp( str, kw.keyword, len )
+        ? kw.token : LEXTOK_IDENT;
+}
+
+#ifdef DEBUG_LEXER
+/**
+ * @brief Checks the keyword table at startup.
+ *
+ * Every token named a keyword in LEXTOK_STR must be found
+ * in its slot and every slot must hold such a keyword, so
+ * a keyword missing from the table or hashed into a taken
+ * slot stops the compiler before it reads any input.
+ *
+ * @author Jan Bobek
+ */
+static struct LexKeywordCheck
+{
+    LexKeywordCheck()
     {
-        m = (l + r) / 2;
-        res = strcmp(
-            str, LEX_KEYWORDS[m].keyword );
-
-        if( res > 0 )
-            l = m + 1;
-        else if( res < 0 )
-            r = m;
-        else /* res == 0 */
-            return LEX_KEYWORDS[m].token;
+        static const char prefix[] = "keyword ";
+        static const size_t plen = sizeof(prefix) - 1;
+
+        bool valid = true;
+        // LEXTOK_KW_WRITELN is the last token.
+        for( unsigned int t = 0; t <= LEXTOK_KW_WRITELN; ++t )
+        {
+            const char* str = LEXTOK_STR[t];
+            if( 0 != strncmp( str, prefix, plen ) )
+                continue;
+
+            if( static_cast< LexToken >( t ) !=
+                lexKeywordLookup( str + plen, strlen( str + plen ) ) )
+            {
+                fprintf( stderr, "Keyword `%s' not found in its slot\n",
+                         str + plen );
+                valid = false;
+            }
+        }
+
+        for( unsigned int i = 0; i < LEX_KEYWORD_COUNT; ++i )
+        {
+            const LexKeyword& kw = LEX_KEYWORDS[i];
+            if( NULL == kw.keyword )
+                continue;
+
+            const char* str = LEXTOK_STR[kw.token];
+            if( 0 != strncmp( str, prefix, plen ) ||
+                0 != strcmp( str + plen, kw.keyword ) ||
+                strlen( kw.keyword ) != kw.length )
+            {
+                fprintf( stderr, "Slot %u holds a stale keyword `%s'\n",
+                         i, kw.keyword );
+                valid = false;
+            }
+        }
+
+        if( !valid )
+            abort();
     }
+} lexKeywordCheck;
+#endif /* DEBUG_LEXER */
 
-    return LEXTOK_IDENT;
+/*************************************************************************/
+/* LexStr                                                                */
+/*************************************************************************/
+LexStr::LexStr()
+: str( "" ),
+  len( 0 )
+{
+}
+
+LexStr::LexStr(
+    const char* str
+    )
+: str( str ),
+  len( strlen( str ) )
+{
+}
+
+LexStr::LexStr(
+    const char* str,
+    size_t len
+    )
+: str( str ),
+  len( len )
+{
+}
+
+/*************************************************************************/
+/* LexSource                                                             */
+/*************************************************************************/
+LexSource::~LexSource()
+{
 }
 
 /*************************************************************************/
@@ -148,15 +745,121 @@ LexAnalyzer::LexAnalyzer(
     FILE* file
     )
 : mFile( file ),
-  mNext( '\0' )
+  mMap( NULL ),
+  mMapLen( 0 ),
+  mCur( NULL ),
+  mEnd( NULL ),
+  mLine( 1 ),
+  mLineStart( NULL ),
+  mLineEnd( NULL ),
+  mFailed( false )
+{
+    if( !mapFile() )
+        readFile();
+
+    mLineStart = mCur;
+    mLineEnd = lexFindByte( mCur, mEnd, '\n' );
+}
+
+LexAnalyzer::LexAnalyzer(
+    const char* buf,
+    size_t len
+    )
+: mFile( NULL ),
+  mMap( NULL ),
+  mMapLen( 0 ),
+  mCur( buf ),
+  mEnd( buf + len ),
+  mLine( 1 ),
+  mLineStart( buf ),
+  mLineEnd( lexFindByte( buf, buf + len, '\n' ) ),
+  mFailed( false )
 {
-    // Load the next character immediately.
-    getc();
 }
 
 LexAnalyzer::~LexAnalyzer()
 {
-    fclose( mFile );
+#if defined( __unix__ ) || defined( __APPLE__ )
+    if( NULL != mMap )
+        munmap( mMap, mMapLen );
+#endif /* __unix__ || __APPLE__ */
+
+    if( NULL != mFile )
+        fclose( mFile );
+}
+
+bool
+LexAnalyzer::mapFile()
+{
+#if defined( __unix__ ) || defined( __APPLE__ )
+    struct stat st;
+    int fd = fileno( mFile );
+
+    // Only a fresh stream of a regular file can be mapped.
+    if( 0 > fd || 0 != fstat( fd, &st ) ||
+        !S_ISREG( st.st_mode ) || 0 != ftell( mFile ) )
+        return false;
+
+    if( 0 == st.st_size )
+    {
+        mCur = mEnd = NULL;
+        return true;
+    }
+
+    void* map = mmap( NULL, st.st_size, PROT_READ,
+                      MAP_PRIVATE, fd, 0 );
+    if( MAP_FAILED == map )
+        return false;
+
+#   ifdef MADV_SEQUENTIAL
+    madvise( map, st.st_size, MADV_SEQUENTIAL );
+#   endif /* MADV_SEQUENTIAL */
+
+    mMap = map;
+    mMapLen = st.st_size;
+
+    mCur = static_cast< const char* >( map );
+    mEnd = mCur + mMapLen;
+    return true;
+#else /* !__unix__ && !__APPLE__ */
+    return false;
+#endif /* !__unix__ && !__APPLE__ */
+}
+
+void
+LexAnalyzer::readFile()
+{
+    size_t len = 0, res;
+
+    do
+    {
+        mBuffer.resize( len + LEX_READ_BLOCK );
+        res = fread( &mBuffer[len], 1, LEX_READ_BLOCK, mFile );
+        len += res;
+    } while( LEX_READ_BLOCK == res );
+
+    if( ferror( mFile ) )
+        perror( "fread" );
+
+    mBuffer.resize( len );
+    mCur = mBuffer.empty() ? NULL : &mBuffer[0];
+    mEnd = mCur + len;
+}
+
+inline int
+LexAnalyzer::peekc() const
+{
+    return mCur < mEnd
+        ? static_cast< unsigned char >( *mCur )
+        : EOF;
+}
+
+inline int
+LexAnalyzer::getc()
+{
+    return mCur < mEnd
+        ? static_cast< unsigned char >( *mCur++ )
+        : EOF;
 }
 
 bool
@@ -164,81 +867,174 @@ LexAnalyzer::read(
     LexElem& elem
     )
 {
-    while( isspace( peekc() ) )
-        getc();
+    if( 1 == read( &elem, 1 ) )
+        return true;
+
+    printError();
+    return false;
+}
+
+size_t
+LexAnalyzer::read(
+    LexElem* elems,
+    size_t count
+    )
+{
+    size_t n = 0;
+
+    // Once failed, stay at the error.
+    while( n < count && !mFailed )
+    {
+        if( !readElem( elems[n] ) )
+            mFailed = true;
+        else if( LEXTOK_EOI == elems[n++].token )
+            break;
+    }
+
+    return n;
+}
+
+void
+LexAnalyzer::printError() const
+{
+    fprintf( stderr, "%s\n", mError.c_str() );
+}
+
+bool
+LexAnalyzer::error(
+    const char* fmt,
+    ...
+    )
+{
+    char buf[256];
+    va_list ap;
+
+    va_start( ap, fmt );
+    vsnprintf( buf, sizeof( buf ), fmt, ap );
+    va_end( ap );
+
+    mError = buf;
+    return false;
+}
 
-    if( isalpha( peekc() ) || '_' == peekc() )
+bool
+LexAnalyzer::readElem(
+    LexElem& elem
+    )
+{
+    if( !skipSpace() )
+        return false;
+
+    locate( elem );
+
+    int c = peekc();
+    if( EOF == c )
+    {
+        elem.token = LEXTOK_EOI;
+        return true;
+    }
+
+    if( LEX_CHAR_CLASS[c] & LEXCC_ALPHA )
         return readIdent( elem );
-    else if( isdigit( peekc() ) )
+    else if( LEX_CHAR_CLASS[c] & LEXCC_DIGIT )
         return readNumberDec( elem );
 
-    switch( peekc() )
+    elem.token = LEX_CHAR_TOKEN[c];
+    if( LEXTOK_EOI != elem.token )
     {
-        case EOF: elem.token = LEXTOK_EOI; return true;
+        getc();
+
+        // Some symbols may continue with another char.
+        switch( elem.token )
+        {
+            case LEXTOK_LT:
+                if( '>' == peekc() )
+                    getc(), elem.token = LEXTOK_NEQ;
+                else if( '=' == peekc() )
+                    getc(), elem.token = LEXTOK_LEQ;
+                break;
+            case LEXTOK_GT:
+                if( '=' == peekc() )
+                    getc(), elem.token = LEXTOK_GEQ;
+                break;
+            case LEXTOK_DOT:
+                if( '.' == peekc() )
+                    getc(), elem.token = LEXTOK_DDOT;
+                break;
+            case LEXTOK_COL:
+                if( '=' == peekc() )
+                    getc(), elem.token = LEXTOK_ASSGN;
+                break;
+            default:
+                break;
+        }
 
+        return true;
+    }
+
+    switch( c )
+    {
         case '&': getc(); return readNumberOct( elem );
         case '$': getc(); return readNumberHex( elem );
         case '\'': getc(); return readString( elem );
-
-        case '+': getc(); elem.token = LEXTOK_PLUS;  return true;
-        case '-': getc(); elem.token = LEXTOK_MINUS; return true;
-        case '*': getc(); elem.token = LEXTOK_MULT;  return true;
-        case '/': getc(); elem.token = LEXTOK_DIV;   return true;
-
-        case '=': getc(); elem.token = LEXTOK_EQ; return true;
-        case '<': getc();
-            if( '>' == peekc() )
-                getc(), elem.token = LEXTOK_NEQ;
-            else if( '=' == peekc() )
-                getc(), elem.token = LEXTOK_LEQ;
-            else
-                elem.token = LEXTOK_LT;
-            return true;
-        case '>': getc();
-            if( '=' == peekc() )
-                getc(), elem.token = LEXTOK_GEQ;
-            else
-                elem.token = LEXTOK_GT;
-            return true;
-
-        case '(': getc(); elem.token = LEXTOK_LPAR; return true;
-        case ')': getc(); elem.token = LEXTOK_RPAR; return true;
-        case '[': getc(); elem.token = LEXTOK_LBRA; return true;
-        case ']': getc(); elem.token = LEXTOK_RBRA; return true;
-
-        case ',': getc(); elem.token = LEXTOK_COMMA; return true;
-        case ';': getc(); elem.token = LEXTOK_SCOL;  return true;
-        case '.': getc();
-            if( '.' == peekc() )
-                getc(), elem.token = LEXTOK_DDOT;
-            else
-                elem.token = LEXTOK_DOT;
-            return true;
-        case ':': getc();
-            if( '=' == peekc() )
-                getc(), elem.token = LEXTOK_ASSGN;
-            else
-                elem.token = LEXTOK_COL;
-            return true;
     }
 
-    fprintf( stderr, "Unknown character '%c' encountered\n",
-             peekc() );
-    return false;
+    return error( "Unknown character '%c' encountered", c );
 }
 
-int
-LexAnalyzer::peekc() const
+void
+LexAnalyzer::locate(
+    LexElem& elem
+    )
 {
-    return mNext;
+    while( mLineEnd < mCur )
+    {
+        ++mLine;
+        mLineStart = mLineEnd + 1;
+        mLineEnd = lexFindByte( mLineStart, mEnd, '\n' );
+    }
+
+    elem.line = mLine;
+    elem.col = mCur - mLineStart + 1;
 }
 
-int
-LexAnalyzer::getc()
+bool
+LexAnalyzer::skipSpace()
 {
-    int c = mNext;
-    mNext = fgetc( mFile );
-    return c;
+    for(;;)
+    {
+        mCur = lexSkipSpace( mCur, mEnd );
+        if( mCur == mEnd )
+            return true;
+
+        const char* next = mCur + 1;
+        if( '{' == *mCur )
+            mCur = lexFindByte( next, mEnd, '}' );
+        else if( '(' == *mCur && next < mEnd && '*' == *next )
+        {
+            // Stop at the ')' of the first "*)".
+            mCur = next + 1;
+            while( (mCur = lexFindByte( mCur, mEnd, '*' )) < mEnd &&
+                   !(++mCur < mEnd && ')' == *mCur) )
+                ;
+        }
+        else if( '/' == *mCur && next < mEnd && '/' == *next )
+        {
+            // The newline is eaten as white space.
+            mCur = lexFindByte( next + 1, mEnd, '\n' );
+            continue;
+        }
+        else
+            return true;
+
+        if( mCur == mEnd )
+        {
+            return error( "Encountered unterminated comment" );
+        }
+
+        // Eat the comment terminator
+        ++mCur;
+    }
 }
 
 bool
@@ -246,15 +1042,16 @@ LexAnalyzer::readIdent(
     LexElem& elem
     )
 {
-    elem.strval.clear();
+    const char* start = mCur;
 
-    do
-    {
-        elem.strval.push_back( getc() );
-    } while( isalnum( peekc() ) || '_' == peekc() );
+    mCur = lexSkipAlnum( mCur + 1, mEnd );
 
     elem.token = lexKeywordLookup(
-        elem.strval.c_str() );
+        start, mCur - start );
+    if( LEXTOK_IDENT == elem.token )
+        elem.ident = IdentTable::global().intern(
+            start, mCur - start );
+
     return true;
 }
 
@@ -266,17 +1063,18 @@ LexAnalyzer::readNumberOct(
     elem.token = LEXTOK_NUMBER;
     elem.intval = 0;
 
-    if( !('0' <= peekc() && peekc() <= '7') )
+    if( !lexCharIs( peekc(), LEXCC_OCT ) )
     {
-        fprintf( stderr, "Invalid octal digit '%c'\n",
-                 peekc() );
-        return false;
+        return error( "Invalid octal digit '%c'", peekc() );
     }
 
     do
     {
+        if( (LEX_INT_MAX >> 3) < elem.intval )
+            return error( "Integer literal out of range" );
+
         elem.intval = elem.intval * 8 + getc() - '0';
-    } while( '0' <= peekc() && peekc() <= '7' );
+    } while( lexCharIs( peekc(), LEXCC_OCT ) );
 
     return true;
 }
@@ -289,17 +1087,39 @@ LexAnalyzer::readNumberDec(
     elem.token = LEXTOK_NUMBER;
     elem.intval = 0;
 
-    if( !isdigit( peekc() ) )
+    if( !lexCharIs( peekc(), LEXCC_DIGIT ) )
     {
-        fprintf( stderr, "Invalid decimal digit '%c'\n",
-                 peekc() );
-        return false;
+        return error( "Invalid decimal digit '%c'", peekc() );
     }
 
-    do
+#ifdef LEX_SWAR
+    while( 8 <= mEnd - mCur )
+    {
+        int64_t part;
+        unsigned int n = lexSwarDigits( mCur, part );
+        if( 0 == n )
+            return true;
+
+        if( (LEX_INT_MAX - part) / LEX_POW10[n] < elem.intval )
+            return error( "Integer literal out of range" );
+
+        elem.intval = elem.intval * LEX_POW10[n] + part;
+        mCur += n;
+
+        if( 8 > n )
+            return true;
+    }
+#endif /* LEX_SWAR */
+
+    while( lexCharIs( peekc(), LEXCC_DIGIT ) )
     {
-        elem.intval = elem.intval * 10 + getc() - '0';
-    } while( isdigit( peekc() ) );
+        int digit = peekc() - '0';
+        if( (LEX_INT_MAX - digit) / 10 < elem.intval )
+            return error( "Integer literal out of range" );
+
+        elem.intval = elem.intval * 10 + digit;
+        getc();
+    }
 
     return true;
 }
@@ -312,20 +1132,21 @@ LexAnalyzer::readNumberHex(
     elem.token = LEXTOK_NUMBER;
     elem.intval = 0;
 
-    if( !isxdigit( peekc() ) )
+    if( !lexCharIs( peekc(), LEXCC_HEX ) )
     {
-        fprintf( stderr, "Invalid hexadecimal digit '%c'\n",
-                 peekc() );
-        return false;
+        return error( "Invalid hexadecimal digit '%c'", peekc() );
     }
 
     do
     {
+        if( (LEX_INT_MAX >> 4) < elem.intval )
+            return error( "Integer literal out of range" );
+
         elem.intval = elem.intval * 16 +
-            (isdigit( peekc() )
+            (lexCharIs( peekc(), LEXCC_DIGIT )
              ? getc() - '0'
-             : tolower( getc() ) - 'a' + 10);
-    } while( isxdigit( peekc() ) );
+             : (getc() | 0x20) - 'a' + 10);
+    } while( lexCharIs( peekc(), LEXCC_HEX ) );
 
     return true;
 }
@@ -335,20 +1156,17 @@ LexAnalyzer::readString(
     LexElem& elem
     )
 {
+    const char* start = mCur;
     elem.token = LEXTOK_STRING;
-    elem.strval.clear();
 
-    while( '\'' != peekc() )
+    mCur = lexFindByte( mCur, mEnd, '\'' );
+    if( mCur == mEnd )
     {
-        if( EOF == peekc() )
-        {
-            fprintf( stderr, "Encountered unterminated string literal\n" );
-            return false;
-        }
-
-        elem.strval.push_back( getc() );
+        return error( "Encountered unterminated string literal" );
     }
 
+    elem.strval = LexStr( start, mCur - start );
+
     // Eat terminal quote
     getc();
     return true;
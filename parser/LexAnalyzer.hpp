@@ -8,9 +8,14 @@
 #ifndef SFE__PARSER__LEXANALYZER_HPP__INCL__
 #define SFE__PARSER__LEXANALYZER_HPP__INCL__
 
+#include <cstddef>
 #include <cstdio>
+#include <stdint.h>
 
 #include <string>
+#include <vector>
+
+#include "parser/IdentTable.hpp"
 
 /**
  * @brief The recognized lexical tokens.
@@ -96,13 +101,15 @@ struct LexKeyword
 {
     /// Pointer to the keyword.
     const char* keyword;
+    /// Length of the keyword.
+    unsigned int length;
     /// Lexical token of the keyword.
     LexToken token;
 };
 
-/// List of the recognized keywords.
+/// Hash table of the recognized keywords; empty slots are NULL.
 extern const LexKeyword LEX_KEYWORDS[];
-/// Number of recognized keywords.
+/// Number of slots in the keyword table; a power of two.
 extern const unsigned int LEX_KEYWORD_COUNT;
 
 /**
@@ -110,11 +117,56 @@ extern const unsigned int LEX_KEYWORD_COUNT;
  *
  * @param[in] str
  *   The string to look up.
+ * @param[in] len
+ *   Length of the string.
  *
  * @return
  *   Lexical token of the string.
  */
-LexToken lexKeywordLookup( const char* str );
+LexToken lexKeywordLookup(
+    const char* str,
+    size_t len
+    );
+
+/**
+ * @brief A non-owning reference to a string.
+ *
+ * The referenced characters are not necessarily
+ * NUL-terminated.
+ *
+ * @author Jan Bobek
+ */
+struct LexStr
+{
+    /**
+     * @brief Initializes an empty reference.
+     */
+    LexStr();
+    /**
+     * @brief Refers to a NUL-terminated string.
+     *
+     * @param[in] str
+     *   The string to refer to.
+     */
+    LexStr( const char* str );
+    /**
+     * @brief Refers to a string of given length.
+     *
+     * @param[in] str
+     *   The string to refer to.
+     * @param[in] len
+     *   Length of the string.
+     */
+    LexStr(
+        const char* str,
+        size_t len
+        );
+
+    /// Start of the string.
+    const char* str;
+    /// Length of the string.
+    size_t len;
+};
 
 /**
  * @brief A single lexical element.
@@ -125,10 +177,58 @@ struct LexElem
 {
     /// The lexical token.
     LexToken token;
-    /// A string value, if applicable.
-    std::string strval;
+    /// An interned identifier, if applicable.
+    const Ident* ident;
+    /// A string value, if applicable; refers
+    /// to the input of the lexical analyzer.
+    LexStr strval;
     /// An integer value, if applicable.
-    int intval;
+    int64_t intval;
+    /// Line of the lexelem, starting at 1.
+    unsigned int line;
+    /// Column of the lexelem, starting at 1.
+    unsigned int col;
+};
+
+/**
+ * @brief A source of lexical elements.
+ *
+ * @author Jan Bobek
+ */
+class LexSource
+{
+public:
+    /**
+     * @brief Releases the source.
+     */
+    virtual ~LexSource();
+
+    /**
+     * @brief Reads a batch of lexical elements.
+     *
+     * Reading stops after the end of input or at
+     * an error, which is then kept for printError().
+     * Once the end of input is reached, any further
+     * read yields it again.
+     *
+     * @param[out] elems
+     *   Where to store the lexelems.
+     * @param[in] count
+     *   Maximal number of lexelems to read.
+     *
+     * @return
+     *   Number of lexelems read; zero only
+     *   if reading failed.
+     */
+    virtual size_t read(
+        LexElem* elems,
+        size_t count
+        ) = 0;
+
+    /**
+     * @brief Prints the error which stopped reading.
+     */
+    virtual void printError() const = 0;
 };
 
 /**
@@ -137,23 +237,47 @@ struct LexElem
  * @author Jan Bobek
  */
 class LexAnalyzer
+: public LexSource
 {
 public:
     /**
      * @brief Initializes the stream.
      *
+     * A stream referring to a regular file is memory-mapped;
+     * anything else (e.g. a pipe) is read in large blocks
+     * into an internal buffer. Either way, the input is then
+     * scanned as a raw character range.
+     *
      * @param[in] file
      *   The stream to bind to.
      */
     LexAnalyzer( FILE* file );
     /**
-     * @brief Closes the stream.
+     * @brief Initializes the analyzer over a buffer.
+     *
+     * The buffer is not copied and must outlive both
+     * the analyzer and all the lexelems it produces.
+     *
+     * @param[in] buf
+     *   The buffer to scan.
+     * @param[in] len
+     *   Length of the buffer.
+     */
+    LexAnalyzer(
+        const char* buf,
+        size_t len
+        );
+    /**
+     * @brief Releases the input and closes the stream.
      */
     ~LexAnalyzer();
 
     /**
      * @brief Reads the next lexical element.
      *
+     * String values of the lexelem remain valid
+     * for the lifetime of the analyzer.
+     *
      * @param[out] elem
      *   Where to store the lexelem info.
      *
@@ -163,8 +287,65 @@ public:
      *   Reading failed.
      */
     bool read( LexElem& elem );
+    /**
+     * @brief Reads a batch of lexical elements.
+     *
+     * @param[out] elems
+     *   Where to store the lexelems.
+     * @param[in] count
+     *   Maximal number of lexelems to read.
+     *
+     * @return
+     *   Number of lexelems read.
+     */
+    size_t read(
+        LexElem* elems,
+        size_t count
+        );
+
+    /**
+     * @brief Prints the error which stopped reading.
+     */
+    void printError() const;
 
 protected:
+    /**
+     * @brief Reads the next lexical element.
+     *
+     * @param[out] elem
+     *   Where to store the lexelem info.
+     *
+     * @retval true
+     *   Reading successful.
+     * @retval false
+     *   Reading failed.
+     */
+    bool readElem( LexElem& elem );
+    /**
+     * @brief Records the position of a lexelem.
+     *
+     * The end of the current line is looked up once per
+     * line, so white space and comments are still skipped
+     * in blocks and most lexelems cost a comparison.
+     *
+     * @param[out] elem
+     *   Where to store the position.
+     */
+    void locate( LexElem& elem );
+    /**
+     * @brief Maps the stream into memory.
+     *
+     * @retval true
+     *   Mapping successful.
+     * @retval false
+     *   The stream cannot be mapped.
+     */
+    bool mapFile();
+    /**
+     * @brief Reads the whole stream into the buffer.
+     */
+    void readFile();
+
     /**
      * @brief Peeks at the next input character.
      *
@@ -180,6 +361,16 @@ protected:
      */
     int getc();
 
+    /**
+     * @brief Skips white space and comments.
+     *
+     * @retval true
+     *   Skipping successful.
+     * @retval false
+     *   Encountered an unterminated comment.
+     */
+    bool skipSpace();
+
     /**
      * @brief Reads an identifier.
      *
@@ -241,10 +432,44 @@ protected:
      */
     bool readString( LexElem& elem );
 
+    /**
+     * @brief Records a lexical error.
+     *
+     * @param[in] fmt
+     *   Format of the error message.
+     *
+     * @return false
+     */
+    bool error(
+        const char* fmt,
+        ...
+        );
+
     /// The bound stream.
     FILE* mFile;
-    /// Next character in the stream.
-    int mNext;
+    /// Start of the memory-mapped stream, if any.
+    void* mMap;
+    /// Length of the memory mapping.
+    size_t mMapLen;
+    /// Contents of a stream which could not be mapped.
+    std::vector< char > mBuffer;
+
+    /// Next character in the input.
+    const char* mCur;
+    /// End of the input.
+    const char* mEnd;
+
+    /// The current line.
+    unsigned int mLine;
+    /// Start of the current line.
+    const char* mLineStart;
+    /// End of the current line.
+    const char* mLineEnd;
+
+    /// Whether reading has failed.
+    bool mFailed;
+    /// Message of the error.
+    std::string mError;
 };
 
 #endif /* !SFE__PARSER__LEXANALYZER_HPP__INCL__ */
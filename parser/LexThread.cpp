@@ -0,0 +1,129 @@
+/** @file
+ * @brief Implementation of the lexer thread.
+ *
+ * @author Jan Bobek
+ * @since 16th October 2026
+ */
+
+#include <sched.h>
+
+#include "parser/LexThread.hpp"
+
+/*************************************************************************/
+/* LexThread                                                             */
+/*************************************************************************/
+LexThread::LexThread(
+    LexAnalyzer& lexan
+    )
+: mLexan( lexan ),
+  mQueue( NULL ),
+  mHead( 0 ),
+  mTail( 0 ),
+  mOffset( 0 ),
+  mStop( false ),
+  mFinished( false ),
+  mStarted( false )
+{
+}
+
+LexThread::~LexThread()
+{
+    if( mStarted )
+    {
+        __atomic_store_n( &mStop, true, __ATOMIC_RELEASE );
+        pthread_join( mThread, NULL );
+    }
+
+    delete[] mQueue;
+}
+
+size_t
+LexThread::read(
+    LexElem* elems,
+    size_t count
+    )
+{
+    if( !mStarted && !mFinished )
+    {
+        mQueue = new Batch[LEX_THREAD_QUEUE];
+        mStarted = 0 == pthread_create( &mThread, NULL, run, this );
+
+        // Without a thread, read in place.
+        mFinished = !mStarted;
+    }
+
+    size_t n = 0;
+    while( n < count && !mFinished )
+    {
+        if( mTail == __atomic_load_n( &mHead, __ATOMIC_ACQUIRE ) )
+        {
+            if( 0 < n )
+                break;
+
+            sched_yield();
+            continue;
+        }
+
+        const Batch& batch = mQueue[mTail & (LEX_THREAD_QUEUE - 1)];
+        for(; n < count && mOffset < batch.count; ++n, ++mOffset )
+            elems[n] = batch.elems[mOffset];
+
+        if( mOffset == batch.count )
+        {
+            mFinished = LEX_THREAD_BATCH > batch.count;
+            mOffset = 0;
+
+            __atomic_store_n( &mTail, mTail + 1, __ATOMIC_RELEASE );
+        }
+    }
+
+    // Past the last batch, the producer is done with the
+    // analyzer, which repeats the end of input or the error.
+    if( 0 == n && mFinished )
+        n = mLexan.read( elems, count );
+
+    return n;
+}
+
+void
+LexThread::printError() const
+{
+    mLexan.printError();
+}
+
+void*
+LexThread::run(
+    void* arg
+    )
+{
+    static_cast< LexThread* >( arg )->produce();
+    return NULL;
+}
+
+void
+LexThread::produce()
+{
+    size_t head = mHead;
+
+    for(;;)
+    {
+        while( LEX_THREAD_QUEUE ==
+               head - __atomic_load_n( &mTail, __ATOMIC_ACQUIRE ) )
+        {
+            if( __atomic_load_n( &mStop, __ATOMIC_ACQUIRE ) )
+                return;
+
+            sched_yield();
+        }
+
+        Batch& batch = mQueue[head & (LEX_THREAD_QUEUE - 1)];
+        size_t count = mLexan.read( batch.elems, LEX_THREAD_BATCH );
+        batch.count = count;
+
+        __atomic_store_n( &mHead, ++head, __ATOMIC_RELEASE );
+
+        if( LEX_THREAD_BATCH > count ||
+            __atomic_load_n( &mStop, __ATOMIC_ACQUIRE ) )
+            return;
+    }
+}
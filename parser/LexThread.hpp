@@ -0,0 +1,122 @@
+/** @file
+ * @brief Declaration of the lexer thread.
+ *
+ * @author Jan Bobek
+ * @since 16th October 2026
+ */
+
+#ifndef SFE__PARSER__LEX_THREAD_HPP__INCL__
+#define SFE__PARSER__LEX_THREAD_HPP__INCL__
+
+#include <pthread.h>
+
+#include "parser/LexAnalyzer.hpp"
+
+/// Number of lexelems in a batch passed between the threads.
+static const size_t LEX_THREAD_BATCH = 256;
+/// Number of batches in the queue; a power of two.
+static const size_t LEX_THREAD_QUEUE = 64;
+
+/**
+ * @brief Runs a lexical analyzer on its own thread.
+ *
+ * The analyzer fills batches of lexelems into a bounded
+ * single-producer/single-consumer queue, from which they
+ * are read on the calling thread. The thread is started
+ * by the first read; until it finishes, nothing else may
+ * intern identifiers.
+ *
+ * @author Jan Bobek
+ */
+class LexThread
+: public LexSource
+{
+public:
+    /**
+     * @brief Initializes the thread.
+     *
+     * @param[in] lexan
+     *   The lexical analyzer to run.
+     */
+    LexThread( LexAnalyzer& lexan );
+    /**
+     * @brief Stops and joins the thread.
+     */
+    ~LexThread();
+
+    /**
+     * @brief Reads a batch of lexical elements.
+     *
+     * Waits only if no lexelem is available.
+     *
+     * @param[out] elems
+     *   Where to store the lexelems.
+     * @param[in] count
+     *   Maximal number of lexelems to read.
+     *
+     * @return
+     *   Number of lexelems read.
+     */
+    size_t read(
+        LexElem* elems,
+        size_t count
+        );
+
+    /**
+     * @brief Prints the error which stopped reading.
+     */
+    void printError() const;
+
+protected:
+    /**
+     * @brief A batch of lexelems.
+     *
+     * @author Jan Bobek
+     */
+    struct Batch
+    {
+        /// The lexelems.
+        LexElem elems[LEX_THREAD_BATCH];
+        /// Number of valid lexelems; less than
+        /// LEX_THREAD_BATCH in the last batch.
+        size_t count;
+    };
+
+    /**
+     * @brief Entry point of the thread.
+     *
+     * @param[in] arg
+     *   The LexThread to run.
+     *
+     * @return NULL
+     */
+    static void* run( void* arg );
+    /**
+     * @brief Fills the queue until the end of input,
+     *   an error or a stop request.
+     */
+    void produce();
+
+    /// The lexical analyzer.
+    LexAnalyzer& mLexan;
+    /// The queue of batches.
+    Batch* mQueue;
+
+    /// Number of batches produced; written by the producer.
+    size_t mHead;
+    /// Number of batches consumed; written by the consumer.
+    size_t mTail;
+    /// Number of lexelems consumed from the oldest batch.
+    size_t mOffset;
+    /// Whether the consumer asks the producer to stop.
+    bool mStop;
+    /// Whether the last batch has been consumed.
+    bool mFinished;
+
+    /// The thread.
+    pthread_t mThread;
+    /// Whether the thread has been started.
+    bool mStarted;
+};
+
+#endif /* !SFE__PARSER__LEX_THREAD_HPP__INCL__ */
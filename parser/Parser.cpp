@@ -5,15 +5,90 @@
  * @since 31st May 2014
  */
 
+#include <climits>
+
 #include "parser/Parser.hpp"
 
+/**
+ * @brief Precedence levels of the binary operators.
+ *
+ * A higher level binds tighter. All operators associate
+ * to the left, except the relational ones, which do not
+ * associate at all.
+ *
+ * @author Jan Bobek
+ */
+enum ParserPrec
+{
+    PARSER_PREC_NONE = 0, ///< Not a binary operator.
+
+    PARSER_PREC_OR,  ///< Expr0: 'or'.
+    PARSER_PREC_AND, ///< Expr1: 'and'.
+    PARSER_PREC_REL, ///< Expr2: relational operators.
+    PARSER_PREC_ADD, ///< Expr3: '+' and '-'.
+    PARSER_PREC_MUL  ///< Expr4: '*', 'div' and 'mod'.
+};
+
+/// Precedence levels of the lexical tokens; the
+/// omitted entries past LEXTOK_AND are not operators.
+static const unsigned char PARSER_BINOP_PREC[] =
+{
+    PARSER_PREC_NONE, // LEXTOK_EOI
+    PARSER_PREC_NONE, // LEXTOK_IDENT
+    PARSER_PREC_NONE, // LEXTOK_NUMBER
+    PARSER_PREC_NONE, // LEXTOK_STRING
+
+    PARSER_PREC_ADD,  // LEXTOK_PLUS
+    PARSER_PREC_ADD,  // LEXTOK_MINUS
+    PARSER_PREC_MUL,  // LEXTOK_MULT
+    PARSER_PREC_MUL,  // LEXTOK_DIV
+    PARSER_PREC_MUL,  // LEXTOK_MOD
+
+    PARSER_PREC_REL,  // LEXTOK_EQ
+    PARSER_PREC_REL,  // LEXTOK_NEQ
+    PARSER_PREC_REL,  // LEXTOK_LT
+    PARSER_PREC_REL,  // LEXTOK_LEQ
+    PARSER_PREC_REL,  // LEXTOK_GT
+    PARSER_PREC_REL,  // LEXTOK_GEQ
+
+    PARSER_PREC_OR,   // LEXTOK_OR
+    PARSER_PREC_AND   // LEXTOK_AND
+};
+
+/**
+ * @brief Looks up the precedence level of a token.
+ *
+ * @param[in] token
+ *   The token to look up.
+ *
+ * @return
+ *   Precedence level of the token,
+ *   PARSER_PREC_NONE if none.
+ */
+static inline unsigned int
+parserBinopPrec(
+    LexToken token
+    )
+{
+    if( sizeof(PARSER_BINOP_PREC) <= static_cast< size_t >( token ) )
+        return PARSER_PREC_NONE;
+
+    return PARSER_BINOP_PREC[token];
+}
+
 /*************************************************************************/
 /* Parser                                                                */
 /*************************************************************************/
 Parser::Parser(
-    LexAnalyzer& lexan
+    LexSource& lexan,
+    AstArena& arena
     )
-: mLexan( lexan )
+: mLexan( lexan ),
+  mArena( arena ),
+  mMain( IdentTable::global().intern( "main" ) ),
+  mIntType( NULL ),
+  mPos( 0 ),
+  mAvail( 0 )
 {
 }
 
@@ -35,19 +110,47 @@ Parser::parse(
 LexToken
 Parser::peek() const
 {
-    return mElem.token;
+    return mRing[mPos].token;
 }
 
-const std::string&
+LexToken
+Parser::peek(
+    size_t k
+    )
+{
+    while( mAvail <= k && fill() )
+        ;
+
+    // Past an error, there is nothing to see.
+    return k < mAvail
+        ? mRing[(mPos + k) & (PARSER_RING_SIZE - 1)].token
+        : LEXTOK_EOI;
+}
+
+const Ident*
+Parser::peekIdent() const
+{
+    return mRing[mPos].ident;
+}
+
+const LexStr&
 Parser::peekStr() const
 {
-    return mElem.strval;
+    return mRing[mPos].strval;
 }
 
-int
+int64_t
 Parser::peekInt() const
 {
-    return mElem.intval;
+    return mRing[mPos].intval;
+}
+
+location_t
+Parser::peekLoc() const
+{
+    return astLocation(
+        mRing[mPos].line,
+        mRing[mPos].col );
 }
 
 bool
@@ -68,7 +171,34 @@ Parser::match(
 bool
 Parser::next()
 {
-    return mLexan.read( mElem );
+    if( 0 < mAvail )
+    {
+        mPos = (mPos + 1) & (PARSER_RING_SIZE - 1);
+        --mAvail;
+    }
+
+    if( 0 == mAvail && !fill() )
+    {
+        mLexan.printError();
+        return false;
+    }
+
+    return true;
+}
+
+bool
+Parser::fill()
+{
+    // Read into the free space behind the lookahead,
+    // up to the end of the ring.
+    size_t tail = (mPos + mAvail) & (PARSER_RING_SIZE - 1);
+    size_t room = PARSER_RING_SIZE - mAvail;
+    if( PARSER_RING_SIZE - tail < room )
+        room = PARSER_RING_SIZE - tail;
+
+    size_t n = mLexan.read( &mRing[tail], room );
+    mAvail += n;
+    return 0 < n;
 }
 
 bool
@@ -78,6 +208,7 @@ Parser::parseProgram(
 {
     AstFunDeclNode* fun;
     AstBlkStmtNode* blk;
+    location_t loc;
 
 #ifdef DEBUG_PARSER
     fprintf( stderr, "parseProgram\n" );
@@ -89,20 +220,30 @@ Parser::parseProgram(
         if( !match( LEXTOK_KW_PROG ) )
             return false;
 
-        prog = new AstProgDeclNode(
-            peekStr().c_str() );
-        blk = new AstBlkStmtNode();
+        prog = located( new( mArena ) AstProgDeclNode(
+                            peekIdent(), mArena ), peekLoc() );
 
         if( !match( LEXTOK_IDENT ) ||
             !match( LEXTOK_SCOL ) ||
-            !parseDeclsGlob( prog ) ||
-            !parseBlock( blk ) ||
+            !parseDeclsGlob( prog ) )
+            return false;
+
+        // The main function starts with its block.
+        loc = peekLoc();
+        blk = located(
+            new( mArena ) AstBlkStmtNode( mArena ), loc );
+
+        if( !parseBlock( blk ) ||
             !match( LEXTOK_DOT ) ||
             !match( LEXTOK_EOI ) )
             return false;
 
-        fun = new AstFunDeclNode( "main" );
-        fun->setResType( new AstIntTypeNode() );
+        // Declarations of the program are global.
+        blk->moveDecls( prog );
+
+        fun = located(
+            new( mArena ) AstFunDeclNode( mMain, mArena ), loc );
+        fun->setResType( new( mArena ) AstIntTypeNode() );
         fun->setBody( blk );
 
         prog->addFun( fun );
@@ -121,63 +262,66 @@ Parser::parseDeclsGlob(
     AstFunDeclNode* fun;
     AstTypeNode* resType;
 
+    for(;;)
+    {
 #ifdef DEBUG_PARSER
-    fprintf( stderr, "parseDeclsGlob\n" );
+        fprintf( stderr, "parseDeclsGlob\n" );
 #endif /* DEBUG_PARSER */
 
-    switch( peek() )
-    {
-    case LEXTOK_KW_FUNC:
-        if( !match( LEXTOK_KW_FUNC ) )
-            return false;
-
-        fun = new AstFunDeclNode(
-            peekStr().c_str() );
-
-        if( !match( LEXTOK_IDENT ) ||
-            !match( LEXTOK_LPAR ) ||
-            !parseFunDeclArgs( fun ) ||
-            !match( LEXTOK_RPAR ) ||
-            !match( LEXTOK_COL ) ||
-            !parseTypeIdent( resType ) ||
-            !match( LEXTOK_SCOL ) ||
-            !parseFunDeclBody( fun ) ||
-            !match( LEXTOK_SCOL ) )
-            return false;
-
-        fun->setResType( resType );
-        prog->addFun( fun );
-
-        return parseDeclsGlob( prog );
-
-    case LEXTOK_KW_PROC:
-        if( !match( LEXTOK_KW_PROC ) )
-            return false;
-
-        fun = new AstFunDeclNode(
-            peekStr().c_str() );
-
-        if( !match( LEXTOK_IDENT ) ||
-            !match( LEXTOK_LPAR ) ||
-            !parseFunDeclArgs( fun ) ||
-            !match( LEXTOK_RPAR ) ||
-            !match( LEXTOK_SCOL ) ||
-            !parseFunDeclBody( fun ) ||
-            !match( LEXTOK_SCOL ) )
-            return false;
-
-        fun->setResType( NULL );
-        prog->addFun( fun );
-
-        return parseDeclsGlob( prog );
-
-    case LEXTOK_KW_CONST:
-    case LEXTOK_KW_VAR:
-    case LEXTOK_KW_BEGIN:
-        return true;
+        switch( peek() )
+        {
+        case LEXTOK_KW_FUNC:
+            if( !match( LEXTOK_KW_FUNC ) )
+                return false;
+
+            fun = located( new( mArena ) AstFunDeclNode(
+                               peekIdent(), mArena ), peekLoc() );
+
+            if( !match( LEXTOK_IDENT ) ||
+                !match( LEXTOK_LPAR ) ||
+                !parseFunDeclArgs( fun ) ||
+                !match( LEXTOK_RPAR ) ||
+                !match( LEXTOK_COL ) ||
+                !parseTypeIdent( resType ) ||
+                !match( LEXTOK_SCOL ) ||
+                !parseFunDeclBody( fun ) ||
+                !match( LEXTOK_SCOL ) )
+                return false;
+
+            fun->setResType( resType );
+            prog->addFun( fun );
+
+            break;
+
+        case LEXTOK_KW_PROC:
+            if( !match( LEXTOK_KW_PROC ) )
+                return false;
+
+            fun = located( new( mArena ) AstFunDeclNode(
+                               peekIdent(), mArena ), peekLoc() );
+
+            if( !match( LEXTOK_IDENT ) ||
+                !match( LEXTOK_LPAR ) ||
+                !parseFunDeclArgs( fun ) ||
+                !match( LEXTOK_RPAR ) ||
+                !match( LEXTOK_SCOL ) ||
+                !parseFunDeclBody( fun ) ||
+                !match( LEXTOK_SCOL ) )
+                return false;
+
+            fun->setResType( NULL );
+            prog->addFun( fun );
+
+            break;
+
+        case LEXTOK_KW_CONST:
+        case LEXTOK_KW_VAR:
+        case LEXTOK_KW_BEGIN:
+            return true;
 
-    default:
-        return error();
+        default:
+            return error();
+        }
     }
 }
 
@@ -186,7 +330,8 @@ Parser::parseFunDeclArgs(
     AstFunDeclNode* fun
     )
 {
-    std::string name;
+    LexToken mode;
+    const Ident* name;
     AstTypeNode* type;
 
 #ifdef DEBUG_PARSER
@@ -195,15 +340,19 @@ Parser::parseFunDeclArgs(
 
     switch( peek() )
     {
+    case LEXTOK_KW_VAR:
+    case LEXTOK_KW_CONST:
     case LEXTOK_IDENT:
-        name = peekStr();
+        if( !parseFunDeclArgMode( mode ) )
+            return false;
 
+        name = peekIdent();
         if( !match( LEXTOK_IDENT ) ||
             !match( LEXTOK_COL ) ||
             !parseTypeIdent( type ) )
             return false;
 
-        fun->addArg( name.c_str(), type );
+        fun->addArg( name, type, mode );
         return parseFunDeclArgsRest( fun );
 
     case LEXTOK_RPAR:
@@ -219,29 +368,62 @@ Parser::parseFunDeclArgsRest(
     AstFunDeclNode* fun
     )
 {
-    std::string name;
+    LexToken mode;
+    const Ident* name;
     AstTypeNode* type;
 
+    for(;;)
+    {
+#ifdef DEBUG_PARSER
+        fprintf( stderr, "parseFunDeclArgsRest\n" );
+#endif /* DEBUG_PARSER */
+
+        switch( peek() )
+        {
+        case LEXTOK_SCOL:
+            if( !match( LEXTOK_SCOL ) ||
+                !parseFunDeclArgMode( mode ) )
+                return false;
+
+            name = peekIdent();
+            if( !match( LEXTOK_IDENT ) ||
+                !match( LEXTOK_COL ) ||
+                !parseTypeIdent( type ) )
+                return false;
+
+            fun->addArg( name, type, mode );
+            break;
+
+        case LEXTOK_RPAR:
+            return true;
+
+        default:
+            return error();
+        }
+    }
+}
+
+bool
+Parser::parseFunDeclArgMode(
+    LexToken& mode
+    )
+{
 #ifdef DEBUG_PARSER
-    fprintf( stderr, "parseFunDeclArgsRest\n" );
+    fprintf( stderr, "parseFunDeclArgMode\n" );
 #endif /* DEBUG_PARSER */
 
     switch( peek() )
     {
-    case LEXTOK_SCOL:
-        if( !match( LEXTOK_SCOL ) )
-            return false;
-
-        name = peekStr();
-        if( !match( LEXTOK_IDENT ) ||
-            !match( LEXTOK_COL ) ||
-            !parseTypeIdent( type ) )
-            return false;
+    case LEXTOK_KW_VAR:
+        mode = LEXTOK_KW_VAR;
+        return match( LEXTOK_KW_VAR );
 
-        fun->addArg( name.c_str(), type );
-        return parseFunDeclArgsRest( fun );
+    case LEXTOK_KW_CONST:
+        mode = LEXTOK_KW_CONST;
+        return match( LEXTOK_KW_CONST );
 
-    case LEXTOK_RPAR:
+    case LEXTOK_IDENT:
+        mode = LEXTOK_EOI;
         return true;
 
     default:
@@ -265,7 +447,8 @@ Parser::parseFunDeclBody(
     case LEXTOK_KW_CONST:
     case LEXTOK_KW_VAR:
     case LEXTOK_KW_BEGIN:
-        blk = new AstBlkStmtNode();
+        blk = located(
+            new( mArena ) AstBlkStmtNode( mArena ), peekLoc() );
         if( !parseBlock( blk ) )
             return false;
 
@@ -285,74 +468,75 @@ Parser::parseDeclsLoc(
     AstBlkStmtNode* blk
     )
 {
-    int val;
+    AstExprNode* val;
     AstTypeNode* type;
-    std::vector< std::string > idents;
-    std::vector< std::string >::const_iterator cur, end;
+    IdentList idents;
+    IdentList::const_iterator cur, end;
 
+    for(;;)
+    {
 #ifdef DEBUG_PARSER
-    fprintf( stderr, "parseDeclsLoc\n" );
+        fprintf( stderr, "parseDeclsLoc\n" );
 #endif /* DEBUG_PARSER */
 
-    switch( peek() )
-    {
-    case LEXTOK_KW_CONST:
-        if( !match( LEXTOK_KW_CONST ) )
-            return false;
+        switch( peek() )
+        {
+        case LEXTOK_KW_CONST:
+            if( !match( LEXTOK_KW_CONST ) )
+                return false;
 
-        idents.push_back( peekStr() );
+            idents.push_back(
+                std::make_pair( peekIdent(), peekLoc() ) );
 
-        if( !match( LEXTOK_IDENT ) ||
-            !parseIdentListRest( idents ) ||
-            !match( LEXTOK_EQ ) ||
-            !parseMinusNumber( val ) ||
-            !match( LEXTOK_SCOL ) )
-            return false;
+            if( !match( LEXTOK_IDENT ) ||
+                !parseIdentListRest( idents ) ||
+                !match( LEXTOK_EQ ) ||
+                !parseExpr0( val ) ||
+                !match( LEXTOK_SCOL ) )
+                return false;
 
-        cur = idents.begin();
-        end = idents.end();
-        for(; cur != end; ++cur )
-            blk->addDecl(
-                new AstConstDeclNode(
-                    cur->c_str(), val ) );
+            addConstDecls( blk, idents, val );
 
-        return parseConstDeclRest( blk )
-            && parseDeclsLoc( blk );
+            if( !parseConstDeclRest( blk ) )
+                return false;
 
-    case LEXTOK_KW_VAR:
-        if( !match( LEXTOK_KW_VAR ) )
-            return false;
+            idents.clear();
+            break;
 
-        idents.push_back( peekStr() );
+        case LEXTOK_KW_VAR:
+            if( !match( LEXTOK_KW_VAR ) )
+                return false;
 
-        if( !match( LEXTOK_IDENT ) ||
-            !parseIdentListRest( idents ) ||
-            !match( LEXTOK_COL ) ||
-            !parseTypeIdent( type ) ||
-            !match( LEXTOK_SCOL ) )
-            return false;
+            idents.push_back(
+                std::make_pair( peekIdent(), peekLoc() ) );
 
-        cur = idents.begin();
-        end = idents.end();
+            if( !match( LEXTOK_IDENT ) ||
+                !parseIdentListRest( idents ) ||
+                !match( LEXTOK_COL ) ||
+                !parseTypeIdent( type ) ||
+                !match( LEXTOK_SCOL ) )
+                return false;
 
-        blk->addDecl(
-            new AstVarDeclNode(
-                (cur++)->c_str(), type ) );
+            // The variables share the type node.
+            cur = idents.begin();
+            end = idents.end();
+            for(; cur != end; ++cur )
+                blk->addDecl(
+                    located( new( mArena ) AstVarDeclNode(
+                                 cur->first, type ), cur->second ) );
 
-        for(; cur != end; ++cur )
-            blk->addDecl(
-                new AstVarDeclNode(
-                    cur->c_str(),
-                    type->clone() ) );
+            if( !parseVarDeclRest( blk ) )
+                return false;
 
-        return parseVarDeclRest( blk )
-            && parseDeclsLoc( blk );
+            idents.clear();
+            break;
 
-    case LEXTOK_KW_BEGIN:
-        return true;
+        case LEXTOK_KW_BEGIN:
+            return true;
 
-    default:
-        return error();
+        default:
+            return error();
+        }
     }
 }
 
@@ -361,42 +545,63 @@ Parser::parseConstDeclRest(
     AstBlkStmtNode* blk
     )
 {
-    int val;
-    std::vector< std::string > idents;
-    std::vector< std::string >::const_iterator cur, end;
+    AstExprNode* val;
+    IdentList idents;
 
+    for(;;)
+    {
 #ifdef DEBUG_PARSER
-    fprintf( stderr, "parseConstRest\n" );
+        fprintf( stderr, "parseConstRest\n" );
 #endif /* DEBUG_PARSER */
 
-    switch( peek() )
-    {
-    case LEXTOK_IDENT:
-        idents.push_back( peekStr() );
-
-        if( !match( LEXTOK_IDENT ) ||
-            !parseIdentListRest( idents ) ||
-            !match( LEXTOK_EQ ) ||
-            !parseMinusNumber( val ) ||
-            !match( LEXTOK_SCOL ) )
-            return false;
+        switch( peek() )
+        {
+        case LEXTOK_IDENT:
+            idents.push_back(
+                std::make_pair( peekIdent(), peekLoc() ) );
+
+            if( !match( LEXTOK_IDENT ) ||
+                !parseIdentListRest( idents ) ||
+                !match( LEXTOK_EQ ) ||
+                !parseExpr0( val ) ||
+                !match( LEXTOK_SCOL ) )
+                return false;
+
+            addConstDecls( blk, idents, val );
+            idents.clear();
+            break;
+
+        case LEXTOK_KW_CONST:
+        case LEXTOK_KW_VAR:
+        case LEXTOK_KW_BEGIN:
+            return true;
 
-        cur = idents.begin();
-        end = idents.end();
-        for(; cur != end; ++cur )
-            blk->addDecl(
-                new AstConstDeclNode(
-                    cur->c_str(), val ) );
+        default:
+            return error();
+        }
+    }
+}
 
-        return parseConstDeclRest( blk );
+void
+Parser::addConstDecls(
+    AstBlkStmtNode* blk,
+    const IdentList& idents,
+    AstExprNode* val
+    )
+{
+    IdentList::const_iterator cur, end;
+    cur = idents.begin();
+    end = idents.end();
 
-    case LEXTOK_KW_CONST:
-    case LEXTOK_KW_VAR:
-    case LEXTOK_KW_BEGIN:
-        return true;
+    const Ident* first = cur->first;
+    for(; cur != end; ++cur )
+    {
+        blk->addDecl(
+            located( new( mArena ) AstConstDeclNode(
+                         cur->first, val ), cur->second ) );
 
-    default:
-        return error();
+        val = located( new( mArena ) AstVarExprNode(
+                           first ), cur->second );
     }
 }
 
@@ -406,47 +611,47 @@ Parser::parseVarDeclRest(
     )
 {
     AstTypeNode* type;
-    std::vector< std::string > idents;
-    std::vector< std::string >::const_iterator cur, end;
+    IdentList idents;
+    IdentList::const_iterator cur, end;
 
+    for(;;)
+    {
 #ifdef DEBUG_PARSER
-    fprintf( stderr, "parseVarDeclRest\n" );
+        fprintf( stderr, "parseVarDeclRest\n" );
 #endif /* DEBUG_PARSER */
 
-    switch( peek() )
-    {
-    case LEXTOK_IDENT:
-        idents.push_back( peekStr() );
-
-        if( !match( LEXTOK_IDENT ) ||
-            !parseIdentListRest( idents ) ||
-            !match( LEXTOK_COL ) ||
-            !parseTypeIdent( type ) ||
-            !match( LEXTOK_SCOL ) )
-            return false;
-
-        cur = idents.begin();
-        end = idents.end();
-
-        blk->addDecl(
-            new AstVarDeclNode(
-                (cur++)->c_str(), type ) );
-
-        for(; cur != end; ++cur )
-            blk->addDecl(
-                new AstVarDeclNode(
-                    cur->c_str(),
-                    type->clone() ) );
-
-        return parseVarDeclRest( blk );
-
-    case LEXTOK_KW_CONST:
-    case LEXTOK_KW_VAR:
-    case LEXTOK_KW_BEGIN:
-        return true;
+        switch( peek() )
+        {
+        case LEXTOK_IDENT:
+            idents.push_back(
+                std::make_pair( peekIdent(), peekLoc() ) );
+
+            if( !match( LEXTOK_IDENT ) ||
+                !parseIdentListRest( idents ) ||
+                !match( LEXTOK_COL ) ||
+                !parseTypeIdent( type ) ||
+                !match( LEXTOK_SCOL ) )
+                return false;
+
+            // The variables share the type node.
+            cur = idents.begin();
+            end = idents.end();
+            for(; cur != end; ++cur )
+                blk->addDecl(
+                    located( new( mArena ) AstVarDeclNode(
+                                 cur->first, type ), cur->second ) );
+
+            idents.clear();
+            break;
+
+        case LEXTOK_KW_CONST:
+        case LEXTOK_KW_VAR:
+        case LEXTOK_KW_BEGIN:
+            return true;
 
-    default:
-        return error();
+        default:
+            return error();
+        }
     }
 }
 
@@ -480,22 +685,27 @@ Parser::parseBlockRest(
     AstBlkStmtNode* blk
     )
 {
+    for(;;)
+    {
 #ifdef DEBUG_PARSER
-    fprintf( stderr, "parseBlockRest\n" );
+        fprintf( stderr, "parseBlockRest\n" );
 #endif /* DEBUG_PARSER */
 
-    switch( peek() )
-    {
-    case LEXTOK_SCOL:
-        return match( LEXTOK_SCOL )
-            && parseStmt( blk )
-            && parseBlockRest( blk );
+        switch( peek() )
+        {
+        case LEXTOK_SCOL:
+            if( !match( LEXTOK_SCOL ) ||
+                !parseStmt( blk ) )
+                return false;
 
-    case LEXTOK_KW_END:
-        return true;
+            break;
 
-    default:
-        return error();
+        case LEXTOK_KW_END:
+            return true;
+
+        default:
+            return error();
+        }
     }
 }
 
@@ -505,7 +715,9 @@ Parser::parseStmt(
     )
 {
     bool inc;
-    std::string str;
+    LexStr str;
+    const Ident* name;
+    location_t loc, nameLoc;
     AstExprNode *expr1, *expr2;
     AstBlkStmtNode *bodyBlk, *elseBlk;
 
@@ -513,16 +725,20 @@ Parser::parseStmt(
     fprintf( stderr, "parseStmt\n" );
 #endif /* DEBUG_PARSER */
 
+    // Statements are located at their first token.
+    loc = peekLoc();
+
     switch( peek() )
     {
     case LEXTOK_IDENT:
-        str = peekStr();
+        name = peekIdent();
 
         return match( LEXTOK_IDENT )
-            && parseStmtIdent( str, blk );
+            && parseStmtIdent( name, loc, blk );
 
     case LEXTOK_KW_IF:
-        bodyBlk = new AstBlkStmtNode();
+        bodyBlk = located(
+            new( mArena ) AstBlkStmtNode( mArena ), loc );
         elseBlk = NULL;
 
         if( !match( LEXTOK_KW_IF ) ||
@@ -533,8 +749,8 @@ Parser::parseStmt(
             return false;
 
         blk->addStmt(
-            new AstIfStmtNode(
-                expr1, bodyBlk, elseBlk ) );
+            located( new( mArena ) AstIfStmtNode(
+                         expr1, bodyBlk, elseBlk ), loc ) );
         return true;
 
     case LEXTOK_KW_WHILE:
@@ -543,18 +759,19 @@ Parser::parseStmt(
             !match( LEXTOK_KW_DO ) )
             return false;
 
-        bodyBlk = new AstBlkStmtNode();
+        bodyBlk = located(
+            new( mArena ) AstBlkStmtNode( mArena ), loc );
         bodyBlk->addStmt(
-            new AstBreakStmtNode(
-                new AstUnopExprNode(
-                    LEXTOK_NOT, expr1 ) ) );
+            located( new( mArena ) AstBreakStmtNode(
+                         located( new( mArena ) AstUnopExprNode(
+                                      LEXTOK_NOT, expr1 ), loc ) ), loc ) );
 
         if( !parseStmt( bodyBlk ) )
             return false;
 
         blk->addStmt(
-            new AstLoopStmtNode(
-                bodyBlk ) );
+            located( new( mArena ) AstLoopStmtNode(
+                         bodyBlk ), loc ) );
 
         return true;
 
@@ -562,7 +779,8 @@ Parser::parseStmt(
         if( !match( LEXTOK_KW_FOR ) )
             return false;
 
-        str = peekStr();
+        name = peekIdent();
+        nameLoc = peekLoc();
 
         if( !match( LEXTOK_IDENT ) ||
             !match( LEXTOK_ASSGN ) ||
@@ -572,41 +790,24 @@ Parser::parseStmt(
             !match( LEXTOK_KW_DO ) )
             return false;
 
-        bodyBlk = new AstBlkStmtNode();
-        bodyBlk->addStmt(
-            new AstBreakStmtNode(
-                new AstBinopExprNode(
-                    (inc ? LEXTOK_GT : LEXTOK_LT),
-                    new AstVarExprNode(
-                        str.c_str() ),
-                    expr2 ) ) );
+        bodyBlk = located(
+            new( mArena ) AstBlkStmtNode( mArena ), loc );
 
         if( !parseStmt( bodyBlk ) )
             return false;
 
-        bodyBlk->addStmt(
-            new AstBinopStmtNode(
-                (inc ? LEXTOK_KW_INC : LEXTOK_KW_DEC),
-                new AstVarExprNode(
-                    str.c_str() ),
-                new AstIntExprNode(
-                    1 ) ) );
-
-        blk->addStmt(
-            new AstBinopStmtNode(
-                LEXTOK_ASSGN,
-                new AstVarExprNode(
-                    str.c_str() ),
-                expr1 ) );
         blk->addStmt(
-            new AstLoopStmtNode(
-                bodyBlk ) );
+            located( new( mArena ) AstForStmtNode(
+                         (inc ? LEXTOK_KW_TO : LEXTOK_KW_DWNTO),
+                         located( new( mArena ) AstVarExprNode(
+                                      name ), nameLoc ),
+                         expr1, expr2, bodyBlk ), loc ) );
 
         return true;
 
     case LEXTOK_KW_EXIT:
         blk->addStmt(
-            new AstExitStmtNode() );
+            located( new( mArena ) AstExitStmtNode(), loc ) );
 
         return match( LEXTOK_KW_EXIT );
 
@@ -620,19 +821,20 @@ Parser::parseStmt(
             !match( LEXTOK_LPAR ) )
             return false;
 
-        str = peekStr();
+        name = peekIdent();
+        nameLoc = peekLoc();
 
         if( !match( LEXTOK_IDENT ) ||
-            !parseStmtLvalIdent( str, expr1 ) ||
+            !parseStmtLvalIdent( name, nameLoc, expr1 ) ||
             !match( LEXTOK_RPAR ) )
             return false;
 
         blk->addStmt(
-            new AstBinopStmtNode(
-                LEXTOK_KW_INC,
-                expr1,
-                new AstIntExprNode(
-                    1 ) ) );
+            located( new( mArena ) AstBinopStmtNode(
+                         LEXTOK_KW_INC,
+                         expr1,
+                         located( new( mArena ) AstIntExprNode(
+                                      1 ), loc ) ), loc ) );
         return true;
 
     case LEXTOK_KW_DEC:
@@ -640,19 +842,20 @@ Parser::parseStmt(
             !match( LEXTOK_LPAR ) )
             return false;
 
-        str = peekStr();
+        name = peekIdent();
+        nameLoc = peekLoc();
 
         if( !match( LEXTOK_IDENT ) ||
-            !parseStmtLvalIdent( str, expr1 ) ||
+            !parseStmtLvalIdent( name, nameLoc, expr1 ) ||
             !match( LEXTOK_RPAR ) )
             return false;
 
         blk->addStmt(
-            new AstBinopStmtNode(
-                LEXTOK_KW_DEC,
-                expr1,
-                new AstIntExprNode(
-                    1 ) ) );
+            located( new( mArena ) AstBinopStmtNode(
+                         LEXTOK_KW_DEC,
+                         expr1,
+                         located( new( mArena ) AstIntExprNode(
+                                      1 ), loc ) ), loc ) );
         return true;
 
     case LEXTOK_KW_READLN:
@@ -660,16 +863,17 @@ Parser::parseStmt(
             !match( LEXTOK_LPAR ) )
             return false;
 
-        str = peekStr();
+        name = peekIdent();
+        nameLoc = peekLoc();
 
         if( !match( LEXTOK_IDENT ) ||
-            !parseStmtLvalIdent( str, expr1 ) ||
+            !parseStmtLvalIdent( name, nameLoc, expr1 ) ||
             !match( LEXTOK_RPAR ) )
             return false;
 
         blk->addStmt(
-            new AstReadStmtNode(
-                "%d", expr1 ) );
+            located( new( mArena ) AstReadStmtNode(
+                         "%d", expr1 ), loc ) );
         return true;
 
     case LEXTOK_KW_WRITE:
@@ -678,15 +882,16 @@ Parser::parseStmt(
             return false;
 
         str = peekStr();
+        nameLoc = peekLoc();
 
         if( !match( LEXTOK_STRING ) ||
             !match( LEXTOK_RPAR ) )
             return false;
 
         blk->addStmt(
-            new AstWriteStmtNode(
-                "%s", new AstStrExprNode(
-                    str.c_str() ) ) );
+            located( new( mArena ) AstWriteStmtNode(
+                         "%s", located( new( mArena ) AstStrExprNode(
+                                            mArena.copy( str ) ), nameLoc ) ), loc ) );
         return true;
 
     case LEXTOK_KW_WRITELN:
@@ -697,8 +902,8 @@ Parser::parseStmt(
             return false;
 
         blk->addStmt(
-            new AstWriteStmtNode(
-                "%d\n", expr1 ) );
+            located( new( mArena ) AstWriteStmtNode(
+                         "%d\n", expr1 ), loc ) );
         return true;
 
     case LEXTOK_SCOL:
@@ -712,7 +917,8 @@ Parser::parseStmt(
 
 bool
 Parser::parseStmtIdent(
-    const std::string& name,
+    const Ident* name,
+    location_t loc,
     AstBlkStmtNode* blk
     )
 {
@@ -727,20 +933,20 @@ Parser::parseStmtIdent(
     {
     case LEXTOK_ASSGN:
     case LEXTOK_LBRA:
-        if( !parseStmtLvalIdent( name, expr ) ||
+        if( !parseStmtLvalIdent( name, loc, expr ) ||
             !match( LEXTOK_ASSGN ) ||
             !parseExpr0( val ) )
             return false;
 
         blk->addStmt(
-            new AstBinopStmtNode(
-                LEXTOK_ASSGN,
-                expr, val ) );
+            located( new( mArena ) AstBinopStmtNode(
+                         LEXTOK_ASSGN,
+                         expr, val ), loc ) );
         return true;
 
     case LEXTOK_LPAR:
-        fun = new AstFunExprNode(
-            name.c_str() );
+        fun = located( new( mArena ) AstFunExprNode(
+                           name, mArena ), loc );
 
         if( !match( LEXTOK_LPAR ) ||
             !parseFunExprArgs( fun ) ||
@@ -748,8 +954,8 @@ Parser::parseStmtIdent(
             return false;
 
         blk->addStmt(
-            new AstFunStmtNode(
-                fun ) );
+            located( new( mArena ) AstFunStmtNode(
+                         fun ), loc ) );
         return true;
 
     default:
@@ -759,7 +965,8 @@ Parser::parseStmtIdent(
 
 bool
 Parser::parseStmtLvalIdent(
-    const std::string& name,
+    const Ident* name,
+    location_t loc,
     AstExprNode*& expr
     )
 {
@@ -775,14 +982,14 @@ Parser::parseStmtLvalIdent(
             !match( LEXTOK_RBRA ) )
             return false;
 
-        expr = new AstArrExprNode(
-            name.c_str(), expr );
+        expr = located( new( mArena ) AstArrExprNode(
+                            name, expr ), loc );
         return true;
 
     case LEXTOK_ASSGN:
     case LEXTOK_RPAR:
-        expr = new AstVarExprNode(
-            name.c_str() );
+        expr = located( new( mArena ) AstVarExprNode(
+                            name ), loc );
         return true;
 
     default:
@@ -802,7 +1009,8 @@ Parser::parseElseBranch(
     switch( peek() )
     {
     case LEXTOK_KW_ELSE:
-        blk = new AstBlkStmtNode();
+        blk = located(
+            new( mArena ) AstBlkStmtNode( mArena ), peekLoc() );
 
         return match( LEXTOK_KW_ELSE )
             && parseStmt( blk );
@@ -850,46 +1058,11 @@ Parser::parseExpr0(
     fprintf( stderr, "parseExpr0\n" );
 #endif /* DEBUG_PARSER */
 
-    switch( peek() )
-    {
-        // Expr3:
-    case LEXTOK_MINUS:
-        // Expr5:
-    case LEXTOK_IDENT:
-    case LEXTOK_NUMBER:
-    case LEXTOK_LPAR:
-        return parseExpr1( expr )
-            && parseExpr0Rest( expr );
-
-    default:
-        return error();
-    }
-}
-
-bool
-Parser::parseExpr0Rest(
-    AstExprNode*& expr
-    )
-{
-    AstExprNode* rop;
-
-#ifdef DEBUG_PARSER
-    fprintf( stderr, "parseExpr0Rest\n" );
-#endif /* DEBUG_PARSER */
+    if( !parseExprPrec( expr, PARSER_PREC_OR ) )
+        return false;
 
     switch( peek() )
     {
-        // Expr0:
-    case LEXTOK_OR:
-        if( !match( LEXTOK_OR ) ||
-            !parseExpr1( rop ) )
-            return true;
-
-        expr = new AstBinopExprNode(
-            LEXTOK_OR, expr, rop );
-
-        return parseExpr0Rest( expr );
-
         // Expr0 follow:
     case LEXTOK_RPAR:
     case LEXTOK_RBRA:
@@ -909,382 +1082,87 @@ Parser::parseExpr0Rest(
 }
 
 bool
-Parser::parseExpr1(
-    AstExprNode*& expr
-    )
-{
-#ifdef DEBUG_PARSER
-    fprintf( stderr, "parseExpr1\n" );
-#endif /* DEBUG_PARSER */
-
-    switch( peek() )
-    {
-        // Expr3:
-    case LEXTOK_MINUS:
-        // Expr5:
-    case LEXTOK_IDENT:
-    case LEXTOK_NUMBER:
-    case LEXTOK_LPAR:
-        return parseExpr2( expr )
-            && parseExpr1Rest( expr );
-
-    default:
-        return error();
-    }
-}
-
-bool
-Parser::parseExpr1Rest(
-    AstExprNode*& expr
+Parser::parseExprPrec(
+    AstExprNode*& expr,
+    unsigned int minPrec
     )
 {
+    int num;
+    LexToken op;
+    location_t loc;
     AstExprNode* rop;
+    unsigned int prec, maxPrec;
 
 #ifdef DEBUG_PARSER
-    fprintf( stderr, "parseExpr1Rest\n" );
+    fprintf( stderr, "parseExprPrec %u\n", minPrec );
 #endif /* DEBUG_PARSER */
 
-    switch( peek() )
+    // Expr3 may start with a minus, which
+    // applies to the whole first Expr4.
+    if( LEXTOK_MINUS == peek() &&
+        PARSER_PREC_ADD >= minPrec )
     {
-        // Expr1:
-    case LEXTOK_AND:
-        if( !match( LEXTOK_AND ) ||
-            !parseExpr2( rop ) )
+        loc = peekLoc();
+
+        if( !match( LEXTOK_MINUS ) )
             return false;
 
-        expr = new AstBinopExprNode(
-            LEXTOK_AND, expr, rop );
+        // A negated number is a literal, so the most
+        // negative integer can be written. As div and
+        // mod truncate, negating the first factor is
+        // the same as negating the whole Expr4.
+        if( LEXTOK_NUMBER == peek() )
+        {
+            if( !convertInt( -peekInt(), num ) )
+                return false;
 
-        return parseExpr1Rest( expr );
+            expr = located( new( mArena ) AstIntExprNode(
+                                num ), loc );
+            if( !match( LEXTOK_NUMBER ) )
+                return false;
 
-        // Expr0:
-    case LEXTOK_OR:
-        // Expr0 follow:
-    case LEXTOK_RPAR:
-    case LEXTOK_RBRA:
-    case LEXTOK_COMMA:
-    case LEXTOK_SCOL:
-    case LEXTOK_KW_THEN:
-    case LEXTOK_KW_ELSE:
-    case LEXTOK_KW_DO:
-    case LEXTOK_KW_TO:
-    case LEXTOK_KW_DWNTO:
-    case LEXTOK_KW_END:
-        return true;
-
-    default:
-        return error();
-    }
-}
-
-bool
-Parser::parseExpr2(
-    AstExprNode*& expr
-    )
-{
-#ifdef DEBUG_PARSER
-    fprintf( stderr, "parseExpr2\n" );
-#endif /* DEBUG_PARSER */
-
-    switch( peek() )
-    {
-        // Expr3:
-    case LEXTOK_MINUS:
-        // Expr5:
-    case LEXTOK_IDENT:
-    case LEXTOK_NUMBER:
-    case LEXTOK_LPAR:
-        return parseExpr3( expr )
-            && parseExpr2Rest( expr );
-
-    default:
-        return error();
-    }
-}
-
-bool
-Parser::parseExpr2Rest(
-    AstExprNode*& expr
-    )
-{
-    AstExprNode* rop;
-
-#ifdef DEBUG_PARSER
-    fprintf( stderr, "parseExpr2Rest\n" );
-#endif /* DEBUG_PARSER */
-
-    switch( peek() )
-    {
-        // Expr2:
-    case LEXTOK_EQ:
-        if( !match( LEXTOK_EQ ) ||
-            !parseExpr3( rop ) )
-            return false;
-
-        expr = new AstBinopExprNode(
-            LEXTOK_EQ, expr, rop );
-        return true;
-
-    case LEXTOK_NEQ:
-        if( !match( LEXTOK_NEQ ) ||
-            !parseExpr3( rop ) )
-            return false;
-
-        expr = new AstBinopExprNode(
-            LEXTOK_NEQ, expr, rop );
-        return true;
-
-    case LEXTOK_LT:
-        if( !match( LEXTOK_LT ) ||
-            !parseExpr3( rop ) )
-            return false;
-
-        expr = new AstBinopExprNode(
-            LEXTOK_LT, expr, rop );
-        return true;
-
-    case LEXTOK_LEQ:
-        if( !match( LEXTOK_LEQ ) ||
-            !parseExpr3( rop ) )
-            return false;
-
-        expr = new AstBinopExprNode(
-            LEXTOK_LEQ, expr, rop );
-        return true;
-
-    case LEXTOK_GT:
-        if( !match( LEXTOK_GT ) ||
-            !parseExpr3( rop ) )
-            return false;
-
-        expr = new AstBinopExprNode(
-            LEXTOK_GT, expr, rop );
-        return true;
-
-    case LEXTOK_GEQ:
-        if( !match( LEXTOK_GEQ ) ||
-            !parseExpr3( rop ) )
-            return false;
-
-        expr = new AstBinopExprNode(
-            LEXTOK_GEQ, expr, rop );
-        return true;
-
-        // Expr0:
-    case LEXTOK_OR:
-        // Expr1:
-    case LEXTOK_AND:
-        // Expr0 follow:
-    case LEXTOK_RPAR:
-    case LEXTOK_RBRA:
-    case LEXTOK_COMMA:
-    case LEXTOK_SCOL:
-    case LEXTOK_KW_THEN:
-    case LEXTOK_KW_ELSE:
-    case LEXTOK_KW_DO:
-    case LEXTOK_KW_TO:
-    case LEXTOK_KW_DWNTO:
-    case LEXTOK_KW_END:
-        return true;
-
-    default:
-        return error();
-    }
-}
-
-bool
-Parser::parseExpr3(
-    AstExprNode*& expr
-    )
-{
-#ifdef DEBUG_PARSER
-    fprintf( stderr, "parseExpr3\n" );
-#endif /* DEBUG_PARSER */
-
-    switch( peek() )
-    {
-        // Expr5:
-    case LEXTOK_IDENT:
-    case LEXTOK_NUMBER:
-    case LEXTOK_LPAR:
-        return parseExpr4( expr )
-            && parseExpr3Rest( expr );
-
-        // Expr3:
-    case LEXTOK_MINUS:
-        if( !match( LEXTOK_MINUS ) ||
-            !parseExpr4( expr ) )
-            return false;
-
-        expr = new AstUnopExprNode(
-            LEXTOK_MINUS, expr );
+            maxPrec = PARSER_PREC_MUL;
+        }
+        else
+        {
+            if( !parseExprPrec( expr, PARSER_PREC_MUL ) )
+                return false;
 
-        return parseExpr3Rest( expr );
+            expr = located( new( mArena ) AstUnopExprNode(
+                                LEXTOK_MINUS, expr ), loc );
 
-    default:
-        return error();
+            maxPrec = PARSER_PREC_ADD;
+        }
     }
-}
-
-bool
-Parser::parseExpr3Rest(
-    AstExprNode*& expr
-    )
-{
-    AstExprNode* rop;
-
-#ifdef DEBUG_PARSER
-    fprintf( stderr, "parseExpr3Rest\n" );
-#endif /* DEBUG_PARSER */
-
-    switch( peek() )
+    else
     {
-        // Expr3:
-    case LEXTOK_PLUS:
-        if( !match( LEXTOK_PLUS ) ||
-            !parseExpr4( rop ) )
+        if( !parseExpr5( expr ) )
             return false;
 
-        expr = new AstBinopExprNode(
-            LEXTOK_PLUS, expr, rop );
-
-        return parseExpr3Rest( expr );
-
-    case LEXTOK_MINUS:
-        if( !match( LEXTOK_MINUS ) ||
-            !parseExpr4( rop ) )
-            return false;
-
-        expr = new AstBinopExprNode(
-            LEXTOK_MINUS, expr, rop );
-
-        return parseExpr3Rest( expr );
-
-        // Expr2:
-    case LEXTOK_EQ:
-    case LEXTOK_NEQ:
-    case LEXTOK_LT:
-    case LEXTOK_LEQ:
-    case LEXTOK_GT:
-    case LEXTOK_GEQ:
-        // Expr0:
-    case LEXTOK_OR:
-        // Expr1:
-    case LEXTOK_AND:
-        // Expr0 follow:
-    case LEXTOK_RPAR:
-    case LEXTOK_RBRA:
-    case LEXTOK_COMMA:
-    case LEXTOK_SCOL:
-    case LEXTOK_KW_THEN:
-    case LEXTOK_KW_ELSE:
-    case LEXTOK_KW_DO:
-    case LEXTOK_KW_TO:
-    case LEXTOK_KW_DWNTO:
-    case LEXTOK_KW_END:
-        return true;
-
-    default:
-        return error();
+        maxPrec = PARSER_PREC_MUL;
     }
-}
 
-bool
-Parser::parseExpr4(
-    AstExprNode*& expr
-    )
-{
-#ifdef DEBUG_PARSER
-    fprintf( stderr, "parseExpr4\n" );
-#endif /* DEBUG_PARSER */
-
-    switch( peek() )
+    for(;;)
     {
-        // Expr5:
-    case LEXTOK_IDENT:
-    case LEXTOK_NUMBER:
-    case LEXTOK_LPAR:
-        return parseExpr5( expr )
-            && parseExpr4Rest( expr );
+        op = peek();
+        prec = parserBinopPrec( op );
 
-    default:
-        return error();
-    }
-}
-
-bool
-Parser::parseExpr4Rest(
-    AstExprNode*& expr
-    )
-{
-    AstExprNode* rop;
-
-#ifdef DEBUG_PARSER
-    fprintf( stderr, "parseExpr4Rest\n" );
-#endif /* DEBUG_PARSER */
-
-    switch( peek() )
-    {
-        // Expr4:
-    case LEXTOK_MULT:
-        if( !match( LEXTOK_MULT ) ||
-            !parseExpr5( rop ) )
-            return false;
-
-        expr = new AstBinopExprNode(
-            LEXTOK_MULT, expr, rop );
-
-        return parseExpr4Rest( expr );
-
-    case LEXTOK_DIV:
-        if( !match( LEXTOK_DIV ) ||
-            !parseExpr5( rop ) )
-            return false;
-
-        expr = new AstBinopExprNode(
-            LEXTOK_DIV, expr, rop );
+        // Anything else is left to the caller.
+        if( prec < minPrec || maxPrec < prec )
+            return true;
 
-        return parseExpr4Rest( expr );
+        // Operations are located at their operator.
+        loc = peekLoc();
 
-    case LEXTOK_MOD:
-        if( !match( LEXTOK_MOD ) ||
-            !parseExpr5( rop ) )
+        if( !match( op ) ||
+            !parseExprPrec( rop, prec + 1 ) )
             return false;
 
-        expr = new AstBinopExprNode(
-            LEXTOK_MOD, expr, rop );
-
-        return parseExpr4Rest( expr );
-
-        // Expr3:
-    case LEXTOK_PLUS:
-    case LEXTOK_MINUS:
-        // Expr2:
-    case LEXTOK_EQ:
-    case LEXTOK_NEQ:
-    case LEXTOK_LT:
-    case LEXTOK_LEQ:
-    case LEXTOK_GT:
-    case LEXTOK_GEQ:
-        // Expr0:
-    case LEXTOK_OR:
-        // Expr1:
-    case LEXTOK_AND:
-        // Expr0 follow:
-    case LEXTOK_RPAR:
-    case LEXTOK_RBRA:
-    case LEXTOK_COMMA:
-    case LEXTOK_SCOL:
-    case LEXTOK_KW_THEN:
-    case LEXTOK_KW_ELSE:
-    case LEXTOK_KW_DO:
-    case LEXTOK_KW_TO:
-    case LEXTOK_KW_DWNTO:
-    case LEXTOK_KW_END:
-        return true;
+        expr = located( new( mArena ) AstBinopExprNode(
+                            op, expr, rop ), loc );
 
-    default:
-        return error();
+        // Relational operators do not associate.
+        maxPrec = (PARSER_PREC_REL == prec ? prec - 1 : prec);
     }
 }
 
@@ -1293,7 +1171,9 @@ Parser::parseExpr5(
     AstExprNode*& expr
     )
 {
-    std::string name;
+    const Ident* name;
+    location_t loc;
+    int num;
 
 #ifdef DEBUG_PARSER
     fprintf( stderr, "parseExpr5\n" );
@@ -1303,14 +1183,18 @@ Parser::parseExpr5(
     {
         // Expr5:
     case LEXTOK_IDENT:
-        name = peekStr();
+        name = peekIdent();
+        loc = peekLoc();
 
         return match( LEXTOK_IDENT )
-            && parseExpr5Ident( name, expr );
+            && parseExpr5Ident( name, loc, expr );
 
     case LEXTOK_NUMBER:
-        expr = new AstIntExprNode( peekInt() );
+        if( !convertInt( peekInt(), num ) )
+            return false;
 
+        expr = located( new( mArena ) AstIntExprNode(
+                            num ), peekLoc() );
         return match( LEXTOK_NUMBER );
 
     case LEXTOK_LPAR:
@@ -1325,7 +1209,8 @@ Parser::parseExpr5(
 
 bool
 Parser::parseExpr5Ident(
-    const std::string& name,
+    const Ident* name,
+    location_t loc,
     AstExprNode*& expr
     )
 {
@@ -1339,8 +1224,8 @@ Parser::parseExpr5Ident(
     {
         // Expr5:
     case LEXTOK_LPAR:
-        expr = fun = new AstFunExprNode(
-            name.c_str() );
+        expr = fun = located( new( mArena ) AstFunExprNode(
+                                  name, mArena ), loc );
 
         return match( LEXTOK_LPAR )
             && parseFunExprArgs( fun )
@@ -1352,8 +1237,8 @@ Parser::parseExpr5Ident(
             !match( LEXTOK_RBRA ) )
             return false;
 
-        expr = new AstArrExprNode(
-            name.c_str(), expr );
+        expr = located( new( mArena ) AstArrExprNode(
+                            name, expr ), loc );
         return true;
 
         // Expr3:
@@ -1385,8 +1270,8 @@ Parser::parseExpr5Ident(
     case LEXTOK_KW_TO:
     case LEXTOK_KW_DWNTO:
     case LEXTOK_KW_END:
-        expr = new AstVarExprNode(
-            name.c_str() );
+        expr = located( new( mArena ) AstVarExprNode(
+                            name ), loc );
         return true;
 
     default:
@@ -1432,25 +1317,28 @@ Parser::parseFunExprArgsRest(
 {
     AstExprNode* arg;
 
+    for(;;)
+    {
 #ifdef DEBUG_PARSER
-    fprintf( stderr, "parseFunExprArgsRest\n" );
+        fprintf( stderr, "parseFunExprArgsRest\n" );
 #endif /* DEBUG_PARSER */
 
-    switch( peek() )
-    {
-    case LEXTOK_COMMA:
-        if( !match( LEXTOK_COMMA ) ||
-            !parseExpr0( arg ) )
-            return false;
+        switch( peek() )
+        {
+        case LEXTOK_COMMA:
+            if( !match( LEXTOK_COMMA ) ||
+                !parseExpr0( arg ) )
+                return false;
 
-        fun->addArg( arg );
-        return parseFunExprArgsRest( fun );
+            fun->addArg( arg );
+            break;
 
-    case LEXTOK_RPAR:
-        return true;
+        case LEXTOK_RPAR:
+            return true;
 
-    default:
-        return error();
+        default:
+            return error();
+        }
     }
 }
 
@@ -1469,12 +1357,16 @@ Parser::parseMinusNumber(
         if( !match( LEXTOK_MINUS ) )
             return false;
 
-        num = -peekInt();
-        return match( LEXTOK_NUMBER );
+        // Only a number carries a value to negate.
+        if( LEXTOK_NUMBER != peek() )
+            return error();
+
+        return convertInt( -peekInt(), num )
+            && match( LEXTOK_NUMBER );
 
     case LEXTOK_NUMBER:
-        num = peekInt();
-        return match( LEXTOK_NUMBER );
+        return convertInt( peekInt(), num )
+            && match( LEXTOK_NUMBER );
 
     default:
         return error();
@@ -1498,7 +1390,10 @@ Parser::parseTypeIdent(
         if( !match( LEXTOK_KW_INT ) )
             return false;
 
-        type = new AstIntTypeNode();
+        if( NULL == mIntType )
+            mIntType = new( mArena ) AstIntTypeNode();
+
+        type = mIntType;
         return true;
 
     case LEXTOK_KW_ARR:
@@ -1518,9 +1413,17 @@ Parser::parseTypeIdent(
                      begin, end );
             return false;
         }
+        // The index offset -begin and the extent
+        // end - begin are both kept in an integer.
+        if( INT_MIN == begin ||
+            INT_MAX < static_cast< int64_t >( end ) - begin )
+        {
+            fprintf( stderr, "Array range [%d;%d] is too large\n",
+                     begin, end );
+            return false;
+        }
 
-        type = new AstArrTypeNode(
-            begin, end, type );
+        type = internArrType( begin, end, type );
         return true;
 
     default:
@@ -1528,33 +1431,78 @@ Parser::parseTypeIdent(
     }
 }
 
+AstTypeNode*
+Parser::internArrType(
+    int begin,
+    int end,
+    AstTypeNode* elemType
+    )
+{
+    ArrTypeKey key(
+        std::make_pair( begin, end ), elemType );
+
+    std::map< ArrTypeKey, AstTypeNode* >::const_iterator it =
+        mArrTypes.find( key );
+    if( mArrTypes.end() != it )
+        return it->second;
+
+    AstTypeNode* type = new( mArena ) AstArrTypeNode(
+        begin, end, elemType );
+
+    mArrTypes.insert( std::make_pair( key, type ) );
+    return type;
+}
+
 bool
 Parser::parseIdentListRest(
-    std::vector< std::string >& idents
+    IdentList& idents
     )
 {
+    for(;;)
+    {
 #ifdef DEBUG_PARSER
-    fprintf( stderr, "parseIdentListRest\n" );
+        fprintf( stderr, "parseIdentListRest\n" );
 #endif /* DEBUG_PARSER */
 
-    switch( peek() )
-    {
-    case LEXTOK_COMMA:
-        if( !match( LEXTOK_COMMA ) )
-            return false;
+        switch( peek() )
+        {
+        case LEXTOK_COMMA:
+            if( !match( LEXTOK_COMMA ) )
+                return false;
 
-        idents.push_back( peekStr() );
+            idents.push_back(
+                std::make_pair( peekIdent(), peekLoc() ) );
 
-        return match( LEXTOK_IDENT )
-            && parseIdentListRest( idents );
+            if( !match( LEXTOK_IDENT ) )
+                return false;
 
-    case LEXTOK_EQ:
-    case LEXTOK_COL:
-        return true;
+            break;
 
-    default:
-        return error();
+        case LEXTOK_EQ:
+        case LEXTOK_COL:
+            return true;
+
+        default:
+            return error();
+        }
+    }
+}
+
+bool
+Parser::convertInt(
+    int64_t val,
+    int& num
+    )
+{
+    if( val < INT_MIN || INT_MAX < val )
+    {
+        fprintf( stderr, "Integer %lld does not fit type `integer'\n",
+                 static_cast< long long >( val ) );
+        return false;
     }
+
+    num = static_cast< int >( val );
+    return true;
 }
 
 bool
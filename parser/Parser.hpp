@@ -8,6 +8,7 @@
 #ifndef SFE__PARSER__PARSER_HPP__INCL__
 #define SFE__PARSER__PARSER_HPP__INCL__
 
+#include <map>
 #include <vector>
 
 #include "ast/AstDeclNode.hpp"
@@ -16,6 +17,9 @@
 #include "ast/AstTypeNode.hpp"
 #include "parser/LexAnalyzer.hpp"
 
+/// Number of lexelems in the lookahead ring; a power of two.
+static const size_t PARSER_RING_SIZE = 256;
+
 /**
  * @brief The parser class.
  *
@@ -28,13 +32,21 @@ public:
      * @brief Initializes the parser.
      *
      * @param[in] lexan
-     *   The lexical analyzer to bind to.
+     *   The source of lexelems to bind to.
+     * @param[in] arena
+     *   The arena to allocate the AST from.
      */
-    Parser( LexAnalyzer& lexan );
+    Parser(
+        LexSource& lexan,
+        AstArena& arena
+        );
 
     /**
      * @brief Parses the input.
      *
+     * The AST lives in the arena of the parser, also when
+     * parsing fails; it is released by resetting the arena.
+     *
      * @param[out] ast
      *   Where to store the AST.
      *
@@ -46,6 +58,9 @@ public:
     bool parse( AstNode*& ast );
 
 protected:
+    /// Identifiers of a list, with their locations.
+    typedef std::vector< std::pair< const Ident*, location_t > > IdentList;
+
     /**
      * @brief Peeks at the current lexelem.
      *
@@ -53,20 +68,65 @@ protected:
      *   The current lexical token.
      */
     LexToken peek() const;
+    /**
+     * @brief Peeks at a lexelem ahead.
+     *
+     * @param[in] k
+     *   How far to look ahead; 0 is the current
+     *   lexelem. Must be less than PARSER_RING_SIZE.
+     *
+     * @return
+     *   The lexical token k lexelems ahead, or
+     *   LEXTOK_EOI if there is an error before it.
+     */
+    LexToken peek( size_t k );
+    /**
+     * @brief Peeks at the current identifier.
+     *
+     * @return
+     *   The current identifier.
+     */
+    const Ident* peekIdent() const;
     /**
      * @brief Peeks at the current strval.
      *
      * @return
      *   The current strval.
      */
-    const std::string& peekStr() const;
+    const LexStr& peekStr() const;
     /**
      * @brief Peeks at the current intval.
      *
      * @return
      *   The current intval.
      */
-    int peekInt() const;
+    int64_t peekInt() const;
+    /**
+     * @brief Peeks at the location of the current lexelem.
+     *
+     * Called only on the current lexelem, which keeps
+     * the locations in the order of the source.
+     *
+     * @return
+     *   The current location.
+     */
+    location_t peekLoc() const;
+    /**
+     * @brief Sets the location of a new node.
+     *
+     * @param[in] node
+     *   The node.
+     * @param[in] loc
+     *   Location of the node.
+     *
+     * @return
+     *   The node.
+     */
+    template< typename T >
+    T* located(
+        T* node,
+        location_t loc
+        );
 
     /**
      * @brief Matches the current lexelem.
@@ -89,6 +149,15 @@ protected:
      *   Reading failed.
      */
     bool next();
+    /**
+     * @brief Reads a batch of lexelems into the ring.
+     *
+     * @retval true
+     *   At least one lexelem was read.
+     * @retval false
+     *   The ring is full, or reading failed.
+     */
+    bool fill();
 
     /**
      * @brief Parses a program.
@@ -141,6 +210,19 @@ protected:
      *   Parsing failed.
      */
     bool parseFunDeclArgsRest( AstFunDeclNode* fun );
+    /**
+     * @brief Parses a passing mode of a function argument.
+     *
+     * @param[out] mode
+     *   LEXTOK_KW_VAR, LEXTOK_KW_CONST or LEXTOK_EOI
+     *   if the argument is passed by value.
+     *
+     * @retval true
+     *   Parsing successful.
+     * @retval false
+     *   Parsing failed.
+     */
+    bool parseFunDeclArgMode( LexToken& mode );
     /**
      * @brief Parses a function body.
      *
@@ -178,6 +260,24 @@ protected:
      *   Parsing failed.
      */
     bool parseConstDeclRest( AstBlkStmtNode* blk );
+    /**
+     * @brief Appends the constants of one definition.
+     *
+     * The value is kept by the first constant only; the
+     * others refer to it, so it is bound and folded once.
+     *
+     * @param[in] blk
+     *   Where to append the local declarations.
+     * @param[in] idents
+     *   Names of the constants.
+     * @param[in] val
+     *   The value.
+     */
+    void addConstDecls(
+        AstBlkStmtNode* blk,
+        const IdentList& idents,
+        AstExprNode* val
+        );
     /**
      * @brief Parses rest of the var section.
      *
@@ -234,6 +334,8 @@ protected:
      *
      * @param[in] name
      *   The encountered identifier.
+     * @param[in] loc
+     *   Location of the identifier.
      * @param[in] blk
      *   The block to append the statement to.
      *
@@ -243,7 +345,8 @@ protected:
      *   Parsing failed.
      */
     bool parseStmtIdent(
-        const std::string& name,
+        const Ident* name,
+        location_t loc,
         AstBlkStmtNode* blk
         );
     /**
@@ -252,6 +355,8 @@ protected:
      *
      * @param[in] name
      *   The encountered identifier.
+     * @param[in] loc
+     *   Location of the identifier.
      * @param[out] expr
      *   Where to store the lval expr.
      *
@@ -261,7 +366,8 @@ protected:
      *   Parsing failed.
      */
     bool parseStmtLvalIdent(
-        const std::string& name,
+        const Ident* name,
+        location_t loc,
         AstExprNode*& expr
         );
     /**
@@ -302,113 +408,27 @@ protected:
      */
     bool parseExpr0( AstExprNode*& expr );
     /**
-     * @brief Parses rest of a 0-expression.
-     *
-     * @param[in,out] expr
-     *   Where to store the expression.
-     *
-     * @retval true
-     *   Parsing successful.
-     * @retval false
-     *   Parsing failed.
-     */
-    bool parseExpr0Rest( AstExprNode*& expr );
-    /**
-     * @brief Parses a 1-expression.
-     *
-     * @param[out] expr
-     *   Where to store the expression.
-     *
-     * @retval true
-     *   Parsing successful.
-     * @retval false
-     *   Parsing failed.
-     */
-    bool parseExpr1( AstExprNode*& expr );
-    /**
-     * @brief Parses rest of a 1-expression.
-     *
-     * @param[in,out] expr
-     *   Where to store the expression.
-     *
-     * @retval true
-     *   Parsing successful.
-     * @retval false
-     *   Parsing failed.
-     */
-    bool parseExpr1Rest( AstExprNode*& expr );
-    /**
-     * @brief Parses a 2-expression.
-     *
-     * @param[out] expr
-     *   Where to store the expression.
-     *
-     * @retval true
-     *   Parsing successful.
-     * @retval false
-     *   Parsing failed.
-     */
-    bool parseExpr2( AstExprNode*& expr );
-    /**
-     * @brief Parses rest of a 2-expression.
-     *
-     * @param[in,out] expr
-     *   Where to store the expression.
-     *
-     * @retval true
-     *   Parsing successful.
-     * @retval false
-     *   Parsing failed.
-     */
-    bool parseExpr2Rest( AstExprNode*& expr );
-    /**
-     * @brief Parses a 3-expression.
-     *
-     * @param[out] expr
-     *   Where to store the expression.
-     *
-     * @retval true
-     *   Parsing successful.
-     * @retval false
-     *   Parsing failed.
-     */
-    bool parseExpr3( AstExprNode*& expr );
-    /**
-     * @brief Parses rest of a 3-expression.
-     *
-     * @param[in,out] expr
-     *   Where to store the expression.
+     * @brief Parses operators of a 0-expression
+     *   down to a precedence level.
      *
-     * @retval true
-     *   Parsing successful.
-     * @retval false
-     *   Parsing failed.
-     */
-    bool parseExpr3Rest( AstExprNode*& expr );
-    /**
-     * @brief Parses a 4-expression.
+     * Chains of operators on one level are parsed in
+     * a loop, so only the nesting of the expression
+     * recurses.
      *
      * @param[out] expr
      *   Where to store the expression.
+     * @param[in] minPrec
+     *   The lowest precedence level to parse.
      *
      * @retval true
      *   Parsing successful.
      * @retval false
      *   Parsing failed.
      */
-    bool parseExpr4( AstExprNode*& expr );
-    /**
-     * @brief Parses rest of a 4-expression.
-     *
-     * @param[in,out] expr
-     *   Where to store the expression.
-     *
-     * @retval true
-     *   Parsing successful.
-     * @retval false
-     *   Parsing failed.
-     */
-    bool parseExpr4Rest( AstExprNode*& expr );
+    bool parseExprPrec(
+        AstExprNode*& expr,
+        unsigned int minPrec
+        );
     /**
      * @brief Parses a 5-expression.
      *
@@ -427,6 +447,8 @@ protected:
      *
      * @param[in] name
      *   The encountered identifier.
+     * @param[in] loc
+     *   Location of the identifier.
      * @param[out] expr
      *   Where to store the expression.
      *
@@ -436,7 +458,8 @@ protected:
      *   Parsing failed.
      */
     bool parseExpr5Ident(
-        const std::string& name,
+        const Ident* name,
+        location_t loc,
         AstExprNode*& expr
         );
     /**
@@ -488,6 +511,27 @@ protected:
      *   Parsing failed.
      */
     bool parseTypeIdent( AstTypeNode*& type );
+    /**
+     * @brief Obtains the shared node of an array type.
+     *
+     * Element types are shared as well, hence
+     * structurally identical types get one node.
+     *
+     * @param[in] begin
+     *   Begin index.
+     * @param[in] end
+     *   End index.
+     * @param[in] elemType
+     *   The shared element type node.
+     *
+     * @return
+     *   The shared array type node.
+     */
+    AstTypeNode* internArrType(
+        int begin,
+        int end,
+        AstTypeNode* elemType
+        );
     /**
      * @brief Parses rest of an identifier list.
      *
@@ -499,8 +543,24 @@ protected:
      * @retval false
      *   Parsing failed.
      */
-    bool parseIdentListRest(
-        std::vector< std::string >& idents
+    bool parseIdentListRest( IdentList& idents );
+
+    /**
+     * @brief Converts a literal to the integer type.
+     *
+     * @param[in] val
+     *   Value of the literal.
+     * @param[out] num
+     *   Where to store the converted value.
+     *
+     * @retval true
+     *   Conversion successful.
+     * @retval false
+     *   The value does not fit the integer type.
+     */
+    bool convertInt(
+        int64_t val,
+        int& num
         );
 
     /**
@@ -510,10 +570,37 @@ protected:
      */
     bool error();
 
-    /// The bound lexical analyzer.
-    LexAnalyzer& mLexan;
-    /// The current lexical element.
-    LexElem mElem;
+    /// The bound source of lexelems.
+    LexSource& mLexan;
+    /// The arena to allocate the AST from.
+    AstArena& mArena;
+    /// Name of the main function; interned before
+    /// the source may start interning on its own.
+    const Ident* mMain;
+
+    /// Key of an array type: the range and the element type.
+    typedef std::pair< std::pair< int, int >, AstTypeNode* > ArrTypeKey;
+    /// The shared integer type node, or NULL if none yet.
+    AstTypeNode* mIntType;
+    /// The shared array type nodes.
+    std::map< ArrTypeKey, AstTypeNode* > mArrTypes;
+    /// Ring of the lexelems read ahead.
+    LexElem mRing[PARSER_RING_SIZE];
+    /// Index of the current lexelem in the ring.
+    size_t mPos;
+    /// Number of lexelems read ahead, including the current one.
+    size_t mAvail;
 };
 
+template< typename T >
+inline T*
+Parser::located(
+    T* node,
+    location_t loc
+    )
+{
+    node->setLoc( loc );
+    return node;
+}
+
 #endif /* !SFE__PARSER__PARSER_HPP__INCL__ */
@@ -11,170 +11,319 @@
 /* SymTable                                                              */
 /*************************************************************************/
 SymTable::SymTable()
-: mResDecl( NULL_TREE )
+: mRes( NULL ),
+  mSlots( SYM_TABLE_SLOTS ),
+  mUsed( 0 )
 {
+    std::vector< Slot >::iterator cur, end;
+    cur = mSlots.begin();
+    end = mSlots.end();
+    for(; cur != end; ++cur )
+        cur->name = NULL;
+
+#ifdef DEBUG_SYMTABLE
+    mHits = mMisses = mProbes = 0;
+#endif /* DEBUG_SYMTABLE */
+}
+
+SymTable::~SymTable()
+{
+#ifdef DEBUG_SYMTABLE
+    fprintf( stderr, "Symbol lookups: %lu hits, %lu misses, %lu slots probed\n",
+             static_cast< unsigned long >( mHits ),
+             static_cast< unsigned long >( mMisses ),
+             static_cast< unsigned long >( mProbes ) );
+#endif /* DEBUG_SYMTABLE */
+}
+
+void
+SymTable::pushScope()
+{
+    Scope scope;
+    scope.bindings = mBindings.size();
+    scope.res = mRes;
+
+    mScopes.push_back( scope );
 }
 
-tree
+void
+SymTable::popScope()
+{
+    const Scope& scope = mScopes.back();
+
+    while( scope.bindings < mBindings.size() )
+    {
+        const Binding& bind = mBindings.back();
+        mSlots[find( bind.name, bind.kind )].head = bind.shadow;
+        mBindings.pop_back();
+    }
+
+    mRes = scope.res;
+    mScopes.pop_back();
+}
+
+AstSym*
 SymTable::getRes() const
 {
-    return mResDecl;
+    return mRes;
 }
 
 bool
 SymTable::setRes(
-    tree resDecl
+    AstSym* res
     )
 {
-    if( NULL_TREE != mResDecl )
+    if( NULL != mRes )
     {
         fprintf( stderr, "Trying to register more than one result declaration\n" );
         return false;
     }
 
-    mResDecl = resDecl;
+    mRes = res;
     return true;
 }
 
-tree
+AstSym*
 SymTable::getVar(
-    const char* name
+    const Ident* name
     ) const
 {
-    std::map< std::string, tree >::const_iterator itr;
-    itr = mVarDecls.find( name );
-    if( mVarDecls.end() == itr )
+    const Binding* bind = get( name, KIND_VAR );
+    if( NULL == bind )
     {
 #ifdef DEBUG_SYMTABLE
-        fprintf( stderr, "Lookup of variable `%s' failed\n", name );
+        fprintf( stderr, "Lookup of variable `%s' failed\n", name->str );
 #endif /* DEBUG_SYMTABLE */
 
-        return NULL_TREE;
+        return NULL;
     }
 
 #ifdef DEBUG_SYMTABLE
-    fprintf( stderr, "Variable `%s' looked up\n", name );
+    fprintf( stderr, "Variable `%s' looked up\n", name->str );
 #endif /* DEBUG_SYMTABLE */
 
-    return itr->second;
+    return bind->sym;
 }
 
 bool
 SymTable::addVar(
-    const char* name,
-    tree varDecl
+    const Ident* name,
+    AstSym* sym
     )
 {
-    std::pair< std::map< std::string, tree >::iterator, bool > res;
-    res = mVarDecls.insert(
-        std::make_pair( std::string( name ), varDecl ) );
-    if( !res.second )
+    if( !add( name, KIND_VAR, sym ) )
     {
-        fprintf( stderr, "Variable `%s' already exists\n", name );
+        fprintf( stderr, "Variable `%s' already exists\n", name->str );
         return false;
     }
 
 #ifdef DEBUG_SYMTABLE
-    fprintf( stderr, "Registered variable `%s'\n", name );
-    debug_tree( varDecl );
+    fprintf( stderr, "Registered variable `%s'\n", name->str );
 #endif /* DEBUG_SYMTABLE */
 
     return true;
 }
 
-tree
+AstSym*
 SymTable::getArr(
-    const char* name,
-    int& off
+    const Ident* name
     ) const
 {
-    std::map< std::string, std::pair< int, tree > >::const_iterator itr;
-    itr = mArrDecls.find( name );
-    if( mArrDecls.end() == itr )
+    const Binding* bind = get( name, KIND_ARR );
+    if( NULL == bind )
     {
 #ifdef DEBUG_SYMTABLE
-        fprintf( stderr, "Lookup of array `%s' failed\n", name );
+        fprintf( stderr, "Lookup of array `%s' failed\n", name->str );
 #endif /* DEBUG_SYMTABLE */
 
-        return NULL_TREE;
+        return NULL;
     }
 
 #ifdef DEBUG_SYMTABLE
-    fprintf( stderr, "Array `%s' looked up\n", name );
+    fprintf( stderr, "Array `%s' looked up\n", name->str );
 #endif /* DEBUG_SYMTABLE */
 
-    off = itr->second.first;
-    return itr->second.second;
+    return bind->sym;
 }
 
 bool
 SymTable::addArr(
-    const char* name,
-    int off,
-    tree arrDecl
+    const Ident* name,
+    AstSym* sym
     )
 {
-    std::pair< std::map< std::string, std::pair< int, tree > >::iterator, bool > res;
-    res = mArrDecls.insert(
-        std::make_pair(
-            std::string( name ),
-            std::make_pair( off, arrDecl ) ) );
-    if( !res.second )
+    if( !add( name, KIND_ARR, sym ) )
     {
-        fprintf( stderr, "Array `%s' already exists\n", name );
+        fprintf( stderr, "Array `%s' already exists\n", name->str );
         return false;
     }
 
 #ifdef DEBUG_SYMTABLE
-    fprintf( stderr, "Registered array `%s'\n", name );
-    debug_tree( arrDecl );
+    fprintf( stderr, "Registered array `%s'\n", name->str );
 #endif /* DEBUG_SYMTABLE */
 
     return true;
 }
 
-tree
+AstSym*
 SymTable::getFun(
-    const char* name
+    const Ident* name
     ) const
 {
-    std::map< std::string, tree >::const_iterator itr;
-    itr = mFunDecls.find( name );
-    if( mFunDecls.end() == itr )
+    const Binding* bind = get( name, KIND_FUN );
+    if( NULL == bind )
     {
 #ifdef DEBUG_SYMTABLE
-        fprintf( stderr, "Lookup of function `%s' failed\n", name );
+        fprintf( stderr, "Lookup of function `%s' failed\n", name->str );
 #endif /* DEBUG_SYMTABLE */
 
-        return NULL_TREE;
+        return NULL;
     }
 
 #ifdef DEBUG_SYMTABLE
-    fprintf( stderr, "Function `%s' looked up\n", name );
+    fprintf( stderr, "Function `%s' looked up\n", name->str );
 #endif /* DEBUG_SYMTABLE */
 
-    return itr->second;
+    return bind->sym;
 }
 
 bool
 SymTable::addFun(
-    const char* name,
-    tree funDecl
+    const Ident* name,
+    AstSym* sym
     )
 {
-    std::pair< std::map< std::string, tree >::iterator, bool > res;
-    res = mFunDecls.insert(
-        std::make_pair( std::string( name ), funDecl ) );
-    if( !res.second )
+    if( !add( name, KIND_FUN, sym ) )
     {
-        fprintf( stderr, "Function `%s' already exists\n", name );
+        fprintf( stderr, "Function `%s' already exists\n", name->str );
         return false;
     }
 
 #ifdef DEBUG_SYMTABLE
-    fprintf( stderr, "Registered function `%s'\n", name );
-    debug_tree( funDecl );
+    fprintf( stderr, "Registered function `%s'\n", name->str );
 #endif /* DEBUG_SYMTABLE */
 
     return true;
 }
+
+const SymTable::Binding*
+SymTable::get(
+    const Ident* name,
+    Kind kind
+    ) const
+{
+    size_t idx = find( name, kind );
+    const Slot& slot = mSlots[idx];
+
+#ifdef DEBUG_SYMTABLE
+    // The probe sequence starts at the home slot.
+    mProbes += ((idx - name->hash - kind) & (mSlots.size() - 1)) + 1;
+#endif /* DEBUG_SYMTABLE */
+
+    if( NULL == slot.name ||
+        SYM_TABLE_NONE == slot.head )
+    {
+#ifdef DEBUG_SYMTABLE
+        ++mMisses;
+#endif /* DEBUG_SYMTABLE */
+
+        return NULL;
+    }
+
+#ifdef DEBUG_SYMTABLE
+    ++mHits;
+#endif /* DEBUG_SYMTABLE */
+
+    return &mBindings[slot.head];
+}
+
+bool
+SymTable::add(
+    const Ident* name,
+    Kind kind,
+    AstSym* sym
+    )
+{
+    size_t idx = find( name, kind );
+    if( NULL == mSlots[idx].name )
+    {
+        // Keep at least a quarter of the slots free.
+        if( 3 * mSlots.size() <= 4 * (mUsed + 1) )
+        {
+            grow();
+            idx = find( name, kind );
+        }
+
+        mSlots[idx].name = name;
+        mSlots[idx].kind = kind;
+        mSlots[idx].head = SYM_TABLE_NONE;
+        ++mUsed;
+    }
+
+    Slot& slot = mSlots[idx];
+    if( SYM_TABLE_NONE != slot.head &&
+        mScopes.size() == mBindings[slot.head].scope )
+        return false;
+
+    Binding bind;
+    bind.name = name;
+    bind.kind = kind;
+    bind.sym = sym;
+    bind.scope = mScopes.size();
+    bind.shadow = slot.head;
+
+    slot.head = static_cast< uint32_t >( mBindings.size() );
+    mBindings.push_back( bind );
+    return true;
+}
+
+size_t
+SymTable::find(
+    const Ident* name,
+    Kind kind
+    ) const
+{
+    size_t mask = mSlots.size() - 1;
+    size_t idx = (name->hash + kind) & mask;
+
+    while( NULL != mSlots[idx].name &&
+           (name != mSlots[idx].name || kind != mSlots[idx].kind) )
+        idx = (idx + 1) & mask;
+
+    return idx;
+}
+
+void
+SymTable::grow()
+{
+    std::vector< Slot > slots( 2 * mSlots.size() );
+    slots.swap( mSlots );
+
+    std::vector< Slot >::iterator cur, end;
+    cur = mSlots.begin();
+    end = mSlots.end();
+    for(; cur != end; ++cur )
+        cur->name = NULL;
+
+    cur = slots.begin();
+    end = slots.end();
+    for(; cur != end; ++cur )
+        if( NULL != cur->name )
+            mSlots[find( cur->name, cur->kind )] = *cur;
+}
+
+/*************************************************************************/
+/* SymScope                                                              */
+/*************************************************************************/
+SymScope::SymScope(
+    SymTable& symTable
+    )
+: mSymTable( symTable )
+{
+    mSymTable.pushScope();
+}
+
+SymScope::~SymScope()
+{
+    mSymTable.popScope();
+}
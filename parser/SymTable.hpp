@@ -8,137 +8,338 @@
 #ifndef SFE__PARSER__SYM_TABLE_HPP__INCL__
 #define SFE__PARSER__SYM_TABLE_HPP__INCL__
 
-#include <map>
-#include <string>
+#include <stdint.h>
+
+#include <vector>
 
 #include "ast/AstNode.hpp"
+#include "parser/IdentTable.hpp"
+
+/// Index of no binding.
+static const uint32_t SYM_TABLE_NONE = 0xFFFFFFFF;
+/// Initial number of hash slots; a power of two.
+static const size_t SYM_TABLE_SLOTS = 64;
 
 /**
  * @brief A symbol table.
  *
+ * The table is a stack of scopes. Every binding shadows
+ * the previous binding of the same name and kind, to which
+ * the name reverts once the scope of the binding is popped.
+ * Hence, entering and leaving a scope costs nothing beyond
+ * the bindings made in it.
+ *
+ * Names are bound to declaration slots; the trees are
+ * filled into the slots as the declarations get translated.
+ *
  * @author Jan Bobek
  */
 class SymTable
 {
 public:
     /**
-     * @brief Initializes the table.
+     * @brief Initializes the table with a single scope.
      */
     SymTable();
+    /**
+     * @brief Prints the lookup statistics
+     *   under DEBUG_SYMTABLE.
+     */
+    ~SymTable();
+
+    /**
+     * @brief Enters a new scope.
+     */
+    void pushScope();
+    /**
+     * @brief Leaves the innermost scope, dropping
+     *   all the bindings made in it.
+     */
+    void popScope();
 
     /**
-     * @brief Obtains a registered result declaration.
+     * @brief Obtains a registered result slot.
      *
      * @return
-     *   The result declaration.
+     *   The result slot.
      */
-    tree getRes() const;
+    AstSym* getRes() const;
     /**
-     * @brief Sets a result declaration.
+     * @brief Sets a result slot.
      *
-     * @param[in] resDecl
-     *   The result declaration.
+     * The slot is dropped with the innermost scope.
+     *
+     * @param[in] res
+     *   The result slot.
      *
      * @retval true
      *   Registration succeeded.
      * @retval false
      *   Registration failed.
      */
-    bool setRes( tree resDecl );
+    bool setRes( AstSym* res );
 
     /**
-     * @brief Looks up a variable declaration.
+     * @brief Looks up a variable slot.
      *
      * @param[in] name
      *   Name of the variable.
      *
      * @return
-     *   Found variable declaration.
+     *   Found variable slot.
      */
-    tree getVar( const char* name ) const;
+    AstSym* getVar( const Ident* name ) const;
     /**
-     * @brief Registers a variable declaration.
+     * @brief Registers a variable slot.
      *
      * @param[in] name
      *   Name of the variable.
-     * @param[in] varDecl
-     *   The variable declaration.
+     * @param[in] sym
+     *   The variable slot.
      *
      * @retval true
      *   Registration succeeded.
      * @retval false
      *   Registration failed.
      */
-    bool addVar( const char* name, tree varDecl );
+    bool addVar( const Ident* name, AstSym* sym );
 
     /**
-     * @brief Looks up an array declaration.
+     * @brief Looks up an array slot.
      *
      * @param[in] name
      *   Name of the array.
-     * @param[out] off
-     *   Array index offset.
      *
      * @return
-     *   Found array declaration.
+     *   Found array slot.
      */
-    tree getArr( const char* name, int& off ) const;
+    AstSym* getArr( const Ident* name ) const;
     /**
-     * @brief Registers an array declaration.
+     * @brief Registers an array slot.
      *
      * @param[in] name
      *   Name of the variable.
-     * @param[in] off
-     *   Array index offset.
-     * @param[in] arrDecl
-     *   The array declaration.
+     * @param[in] sym
+     *   The array slot.
      *
      * @retval true
      *   Registration succeeded.
      * @retval false
      *   Registration failed.
      */
-    bool addArr(
-        const char* name,
-        int off,
-        tree arrDecl
-        );
+    bool addArr( const Ident* name, AstSym* sym );
 
     /**
-     * @brief Looks up a function declaration.
+     * @brief Looks up a function slot.
      *
      * @param[in] name
      *   Name of the function.
      *
      * @return
-     *   Found function declaration.
+     *   Found function slot.
      */
-    tree getFun( const char* name ) const;
+    AstSym* getFun( const Ident* name ) const;
     /**
-     * @brief Registers a function declaration.
+     * @brief Registers a function slot.
      *
      * @param[in] name
      *   Name of the function.
-     * @param[in] funDecl
-     *   The function declaration.
+     * @param[in] sym
+     *   The function slot.
      *
      * @retval true
      *   Registration succeeded.
      * @retval false
      *   Registration failed.
      */
-    bool addFun( const char* name, tree funDecl );
+    bool addFun( const Ident* name, AstSym* sym );
 
 protected:
-    /// Result declaration.
-    tree mResDecl;
-
-    /// Variable/constant declarations.
-    std::map< std::string, tree > mVarDecls;
-    /// Array declarations.
-    std::map< std::string, std::pair< int, tree > > mArrDecls;
-    /// Function declarations.
-    std::map< std::string, tree > mFunDecls;
+    /**
+     * @brief Kinds of the bindings.
+     *
+     * @author Jan Bobek
+     */
+    enum Kind
+    {
+        KIND_VAR, ///< A variable or constant.
+        KIND_ARR, ///< An array.
+        KIND_FUN  ///< A function.
+    };
+
+    /**
+     * @brief A binding of a name.
+     *
+     * @author Jan Bobek
+     */
+    struct Binding
+    {
+        /// Name of the symbol.
+        const Ident* name;
+        /// Kind of the symbol.
+        Kind kind;
+        /// Slot of the symbol.
+        AstSym* sym;
+        /// Scope of the binding.
+        size_t scope;
+        /// The shadowed binding or SYM_TABLE_NONE.
+        uint32_t shadow;
+    };
+
+    /**
+     * @brief A hash slot of a name.
+     *
+     * Slots are never freed; when the last binding of
+     * a name is dropped, the slot only loses its head.
+     *
+     * @author Jan Bobek
+     */
+    struct Slot
+    {
+        /// Name of the symbols, or NULL if the slot is free.
+        const Ident* name;
+        /// Kind of the symbols.
+        Kind kind;
+        /// The innermost binding or SYM_TABLE_NONE.
+        uint32_t head;
+    };
+
+    /**
+     * @brief A saved scope.
+     *
+     * @author Jan Bobek
+     */
+    struct Scope
+    {
+        /// Number of bindings made before the scope.
+        size_t bindings;
+        /// Result slot of the enclosing scope.
+        AstSym* res;
+    };
+
+    /**
+     * @brief Looks up a binding.
+     *
+     * @param[in] name
+     *   Name of the symbol.
+     * @param[in] kind
+     *   Kind of the symbol.
+     *
+     * @return
+     *   The innermost binding, or NULL if none.
+     */
+    const Binding* get(
+        const Ident* name,
+        Kind kind
+        ) const;
+    /**
+     * @brief Binds a name in the innermost scope.
+     *
+     * @param[in] name
+     *   Name of the symbol.
+     * @param[in] kind
+     *   Kind of the symbol.
+     * @param[in] sym
+     *   Slot of the symbol.
+     *
+     * @retval true
+     *   The name was bound.
+     * @retval false
+     *   The name is already bound in the scope.
+     */
+    bool add(
+        const Ident* name,
+        Kind kind,
+        AstSym* sym
+        );
+
+    /**
+     * @brief Finds the slot of a name.
+     *
+     * @param[in] name
+     *   Name of the symbol.
+     * @param[in] kind
+     *   Kind of the symbol.
+     *
+     * @return
+     *   Index of the slot of the name, or of
+     *   the free slot where it belongs.
+     */
+    size_t find(
+        const Ident* name,
+        Kind kind
+        ) const;
+    /**
+     * @brief Doubles the number of slots.
+     */
+    void grow();
+
+    /// Result slot.
+    AstSym* mRes;
+
+    /// All the bindings, innermost last.
+    std::vector< Binding > mBindings;
+    /// The hash slots.
+    std::vector< Slot > mSlots;
+    /// Number of used slots.
+    size_t mUsed;
+    /// The enclosing scopes, innermost last.
+    std::vector< Scope > mScopes;
+
+#ifdef DEBUG_SYMTABLE
+    /// Number of lookups which found a binding.
+    mutable size_t mHits;
+    /// Number of lookups which found nothing.
+    mutable size_t mMisses;
+    /// Number of slots probed by lookups.
+    mutable size_t mProbes;
+#endif /* DEBUG_SYMTABLE */
+
+private:
+    /**
+     * @brief Tables cannot be copied; declared only.
+     */
+    SymTable( const SymTable& );
+    /**
+     * @brief Tables cannot be assigned; declared only.
+     */
+    SymTable& operator=( const SymTable& );
+};
+
+/**
+ * @brief Keeps a scope of a SymTable open
+ *   for its lifetime.
+ *
+ * @author Jan Bobek
+ */
+class SymScope
+{
+public:
+    /**
+     * @brief Enters a new scope.
+     *
+     * @param[in,out] symTable
+     *   The SymTable to use.
+     */
+    SymScope( SymTable& symTable );
+    /**
+     * @brief Leaves the scope.
+     */
+    ~SymScope();
+
+protected:
+    /// The SymTable used.
+    SymTable& mSymTable;
+
+private:
+    /**
+     * @brief Scopes cannot be copied; declared only.
+     */
+    SymScope( const SymScope& );
+    /**
+     * @brief Scopes cannot be assigned; declared only.
+     */
+    SymScope& operator=( const SymScope& );
 };
 
 #endif /* !SFE__PARSER__SYM_TABLE_HPP__INCL__ */
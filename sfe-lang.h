@@ -8,7 +8,10 @@
 #ifndef SFE__SFE_LANG_H__INCL__
 #define SFE__SFE_LANG_H__INCL__
 
+#include "ast/AstFlat.hpp"
+#include "ast/AstFold.hpp"
 #include "parser/LexAnalyzer.hpp"
+#include "parser/LexThread.hpp"
 #include "parser/Parser.hpp"
 #include "parser/SymTable.hpp"
 
@@ -26,5 +29,12 @@ void register_global_function_declaration( tree functionDecl );
  *   Declaration of the variable.
  */
 void register_global_variable_declaration( tree variable );
+/**
+ * @brief Keeps a shared tree alive.
+ *
+ * @param[in] t
+ *   The tree, referenced only from a cache.
+ */
+void register_global_tree( tree t );
 
 #endif /* !SFE__SFE_LANG_H__INCL__ */
@@ -66,7 +66,8 @@ struct GTY(()) language_function {
   char dummy;
 };
 
-vec<tree, va_gc> * sfe_global_decls_vec = NULL;
+static GTY(()) vec<tree, va_gc> * sfe_global_decls_vec;
+static GTY(()) vec<tree, va_gc> * sfe_global_trees_vec;
 
 /* language hooks */
 struct lang_hooks lang_hooks = LANG_HOOKS_INITIALIZER;
@@ -164,9 +165,14 @@ void register_global_variable_declaration( tree variable ) {
   vec_safe_push( sfe_global_decls_vec, variable );
 }
 
+void register_global_tree( tree t ) {
+  vec_safe_push( sfe_global_trees_vec, t );
+}
+
 void sfe_parse_input_files(const char** filenames, unsigned filename_count) {
   FILE* file;
   AstNode* ast;
+  AstArena arena;
 
   for(unsigned i = 0; i < filename_count; i++) {
     printf("Processing file `%s'\n", filenames[i]);
@@ -177,28 +183,69 @@ void sfe_parse_input_files(const char** filenames, unsigned filename_count) {
     }
 
     LexAnalyzer lexan( file );
-    Parser parser( lexan );
-
-    if( !parser.parse( ast ) )
+    LexThread lexthr( lexan );
+    Parser parser( flag_threaded_lexer
+                   ? static_cast< LexSource& >( lexthr )
+                   : static_cast< LexSource& >( lexan ),
+                   arena );
+
+    /* The parser hands out all locations of the file. */
+    linemap_add( line_table, LC_ENTER, 0, filenames[i], 1 );
+    bool parsed = parser.parse( ast );
+    linemap_add( line_table, LC_LEAVE, 0, NULL, 0 );
+
+    if( !parsed )
     {
         printf( "Failed to parse file `%s'\n", filenames[i] );
+        arena.reset();
         continue;
     }
 
     printf( "File `%s' parsed successfully\n", filenames[i] );
+
+    // Both the tree and the flat AST get folded.
+    AstFold folder( arena );
+    ast = ast->foldConst( folder );
+#ifdef DEBUG_FOLD
+    fprintf( stderr, "AST fold: %lu nodes folded\n",
+             folder.folded() );
+#endif /* DEBUG_FOLD */
+
     // ast->print( 1, stdout );
 
-    if( !ast->translate() )
+    bool translated;
+    if( flag_flat_ast )
+    {
+        AstFlat flatAst( *ast );
+#ifdef DEBUG_ARENA
+        fprintf( stderr, "Flat AST: %lu nodes, %lu bytes\n",
+                 (unsigned long) flatAst.size(),
+                 (unsigned long) flatAst.usedBytes() );
+#endif /* DEBUG_ARENA */
+
+        // The flat AST does not need the arena.
+        arena.reset();
+        translated = flatAst.translate();
+    }
+    else
+        translated = ast->bind() && ast->translate();
+
+    if( !translated )
     {
         printf( "Failed to translate file `%s'\n", filenames[i] );
-        delete ast;
+        arena.reset();
         continue;
     }
 
     printf( "File `%s' translated successfully\n", filenames[i] );
-    delete ast;
+    arena.reset();
   }
 
+#ifdef DEBUG_ARENA
+  fprintf( stderr, "AST arena peak: %lu bytes\n",
+           (unsigned long) arena.peakBytes() );
+#endif /* DEBUG_ARENA */
+
   /* if(flag_aaa) printf("Flag aaa is on\n"); */
   /* else printf("Flag aaa is off\n"); */
 